@@ -1,5 +1,10 @@
 #pragma once
 
+#include <utils/Reactor/Reactor.h>
+
+#include <chrono>
+#include <optional>
+
 namespace app
 {
     class MyModule
@@ -8,11 +13,15 @@ namespace app
         MyModule() = default;
         ~MyModule() = default;
 
-        void init() {}
+        /** Initialize the module. The module registers its file descriptors in the reactor, which outlives it. */
+        void init(utils::Reactor&) {}
         void start() {}
         void stop() {}
         void update() {}
+
+        /** Get the time of the next update of the module, or nothing if the module only reacts to its file descriptors. */
+        std::optional<std::chrono::steady_clock::time_point> next_deadline() const { return std::nullopt; }
     };  
 
 
-}
\ No newline at end of file
+}
@@ -7,10 +7,26 @@
 #include <memory>
 
 #include <string_view>
+#include <array>
+#include <span>
+#include <utility>
 #include <iostream>
 #include <functional>
 #include <cassert>
 #include <optional>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <unordered_set>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <mutex>
+#include <sstream>
+#include <exception>
+#include <list>
+#include <future>
+#include <cstddef>
 
 /* Implementation Details
 
@@ -192,6 +208,46 @@
     In the case of state handler override, the Fsm gives the ability to retrieve the actual State handler registered to the State ID to have access
     to its entry, do and exit functions, in the case the new state handler wants to call them.
 
+    Lazy states
+    -----------
+
+    A machine with a huge and sparse state set (e.g. a generated machine) can register its states with a factory instead of a state handler
+    (see register_state_factory()). The state handler is built by the factory the first time the state is entered (or found with find_state()),
+    then it is kept in the state handlers table like a registered state handler. The built lazy states can be bounded by a cache capacity
+    (see set_lazy_state_cache_capacity()): the least recently entered ones are evicted from the table, and rebuilt on their next entry.
+
+    Registering a state handler for a lazy state makes it a regular state: its factory is dropped, so the override is never evicted.
+
+    Orthogonal regions
+    ------------------
+
+    A machine can be split into orthogonal regions, i.e. independent state dimensions (e.g. a connection state and an authentication state)
+    instead of their product state space. A region is a sub-machine, with its own states, current state and transition overrides, returned by
+    region(). The machine owns its regions:
+
+    - start() starts the machine (if it has an initial state) then its regions, in creation order,
+    - update() updates the machine then its regions. When a region exits, the whole machine exits,
+    - exit() exits the regions then the machine, in one step.
+
+    With set_region_thread_pool(), the regions are updated in parallel on a thread pool. The regions must then be independent: a region must
+    not access the other regions, nor data shared without synchronization.
+
+    Telemetry
+    ---------
+
+    A telemetry slot (see FsmTelemetry) can be attached to the machine with set_telemetry_slot(). The machine then publishes its current
+    state, with the Tsc timestamp, at each transition (including the start and the exit), and counts its updates. The owner of the slot can
+    pass a callback, called when the machine frees the slot (detach, replacement or destruction), so that it knows which machines still write
+    to its segment.
+
+    Extensions
+    ----------
+
+    The state of the opt-in features (declared and guarded transitions, transition counters, lazy states, regions and telemetry) is kept in
+    an extension allocated on the first use of one of them, so that a plain machine stays small (a fleet may hold millions of them). Without
+    extension, an update and a transition cost a single pointer test for all the features. The thread pool and the telemetry slot are bound
+    by templates, so that this header does not depend on ThreadPool.h, FsmTelemetrySlot.h and Tsc.h: the caller includes them.
+
 */
 
 // Detect compiler and define a macro for getting function signature
@@ -211,12 +267,48 @@ constexpr std::size_t typeHash(std::string_view name) {
     return hash;
 }
 
-namespaceapp::utils 
+// Compile-time extraction of an enumerator name from the function signature, e.g. "State1" from 
+// "... enumValueName() [with auto V = StateDefinition::State1; ...]". Empty if the value is not an enumerator.
+template <auto V>
+constexpr std::string_view enumValueName() {
+    std::string_view signature = FUNCTION_SIGNATURE;
+#if defined(_MSC_VER)
+    auto start = signature.find("enumValueName<");
+    if (start == std::string_view::npos)
+        return {};
+    start += 14;
+    auto end = signature.rfind(">(void)");
+#else
+    auto start = signature.find("V = ");
+    if (start == std::string_view::npos)
+        return {};
+    start += 4;
+    auto end = signature.find_first_of(";]", start);
+#endif
+    auto value = signature.substr(start, end - start);
+    // A value which is not an enumerator is printed as a cast, e.g. "(StateDefinition)12"
+    if (value.empty() || value.front() == '(' || value.front() == '-' || (value.front() >= '0' && value.front() <= '9'))
+        return {};
+    auto scope = value.rfind("::");
+    return scope == std::string_view::npos ? value : value.substr(scope + 2);
+}
+
+// Number of enumerator values (from 0) whose name is extracted at compile time: the enumerators beyond it, or negative, have no name
+inline constexpr std::size_t maxNamedEnumValues = 128;
+
+template <typename T, std::size_t... I>
+constexpr std::array<std::string_view, sizeof...(I)> enumNames(std::index_sequence<I...>) {
+    return {enumValueName<static_cast<T>(I)>()...};
+}
+
+namespace app::utils 
 {
 
     /** Type erasure class to represents a state by a value built on a hashed value
      *  of the underlying type.
-     *  The class is mainly used as a key in the state handlers table.
+     *  The class is mainly used as a key in the state handlers table: it only holds this value.
+     *  The names of the enumerators are extracted at compile time, and looked up in the tables of the enum types registered with
+     *  register_names() (by the Fsm, when a state of the type is registered). Only the scoped enums are named, for their values 0 to 127.
      **/ 
     class StateId {
     public:
@@ -224,18 +316,67 @@ namespaceapp::utils
         StateId() : uid(0) {}  // Default value, you may want a different sentinel value
         // Templated constructor to accept any enum class
         template <typename T, typename = std::enable_if_t<std::is_enum_v<T>>>
-        explicit StateId(T state) : uid(getTypeHash<T>() + static_cast<int>(state))  {}
+        explicit StateId(T state) : uid(type_hash_of<T> + static_cast<int>(state))  {}
 
         // Equality operator for unordered_map support
         bool operator==(const StateId& other) const {return uid == other.uid;}
 
+        // Raw value of the identifier, used to build unique names (e.g. in graph exports)
+        int value() const {return uid;}
+
+        // Name of the enumerator (e.g. "State1"), empty if unknown or if its enum type is not registered
+        std::string_view name() const
+        {
+            for (const auto* names = registered_names.load(std::memory_order_acquire); names; names = names->next)
+            {
+                auto value = static_cast<unsigned int>(uid) - static_cast<unsigned int>(names->base);
+                if (value < names->names.size() && !names->names[value].empty())
+                    return names->names[value];
+            }
+            return {};
+        }
+
+        // Register the names of the enumerators of an enum type (values 0 to maxNamedEnumValues - 1), once per type.
+        // Only the scoped enums are named: casting an out of range value to an unscoped enum is not a constant expression.
+        template <typename T>
+        static void register_names()
+        {
+            if constexpr (!std::is_convertible_v<T, std::underlying_type_t<T>>)
+            {
+                static constexpr auto names_table = enumNames<T>(std::make_index_sequence<maxNamedEnumValues>{});
+                static EnumNames names{static_cast<int>(type_hash_of<T>), names_table, nullptr};
+                static const bool registered = (push_names(names), true);
+                (void)registered;
+            }
+        }
+
     private:
         int uid;  
 
+        // Names of the values of a registered enum type, in a list only growing, read without lock
+        struct EnumNames
+        {
+            int base;                                   // identifier of the value 0 of the type
+            std::span<const std::string_view> names;
+            const EnumNames* next;
+        };
+
+        static inline std::atomic<const EnumNames*> registered_names{nullptr};
+
+        static void push_names(EnumNames& names)
+        {
+            names.next = registered_names.load(std::memory_order_relaxed);
+            while (!registered_names.compare_exchange_weak(names.next, &names, std::memory_order_release, std::memory_order_relaxed)) {}
+        }
+
         // Generates a unique integer hash for a type at compile-time
         template <typename T>
         static constexpr std::size_t getTypeHash() {return typeHash(FUNCTION_SIGNATURE);}
 
+        // Hash of a type as a constant: a call to getTypeHash() outside a constant expression may hash the signature at runtime
+        template <typename T>
+        static constexpr std::size_t type_hash_of = getTypeHash<T>();
+
         // Grant std::hash access to private members
         friend struct std::hash<StateId>;
     };
@@ -268,6 +409,8 @@ namespace std {
   
    namespace app::utils 
    {
+
+    struct FsmTelemetrySlot;
    
     /**  This component implements a Finite State Machine (FSM) that allows to register a set of states by defining function pointers to their :
       
@@ -284,44 +427,233 @@ namespace std {
     public:
     
         /** Internal object to store a state handler, keeping pointers to function associated to entry, do and exit behavior.
-         *  @note The name is used for debugging purposes.
+         *  @note The name of the state is the name of its enumerator, given by StateId::name().
          */
         struct State
         {
-            std::string name="unnamed state";
             std::function<void()> on_do=nullptr;
             std::function<void()> on_enter=nullptr;
             std::function<void()> on_exit=nullptr;
+            std::chrono::nanoseconds update_period{0};   ///< period of the updates while the state is active, 0 to update on each scheduling pass
 
             State() = default;
-            State(std::function<void()> on_enter, std::function<void()> on_do, std::function<void()> on_exit, const std::string& name = "unnamed state")
+            State(std::function<void()> on_enter, std::function<void()> on_do, std::function<void()> on_exit)
                 : on_do(on_do), 
                   on_enter(on_enter), 
-                  on_exit(on_exit), 
-                  name(name)  {}
+                  on_exit(on_exit)  {}
         };
 
         Fsm() : current_state_handler(nullptr) 
         {
+            register_state_names<InternalState>();
             set_initial_state(StateId(InternalState::None));
         }
-        virtual ~Fsm() = default;
+        virtual ~Fsm()
+        {
+            // Free the telemetry slot, so that the readers stop reporting the destroyed instance
+            release_telemetry_slot();
+        }
+
+        /** Factory building the handler of a lazy state (see register_state_factory()). */
+        using StateFactory = std::function<State()>;
+
+        /** Update period of a state, declared at registration (see register_state()). */
+        struct UpdatePeriod
+        {
+            std::chrono::nanoseconds period{0};
+        };
+
+        /** Output format of the graph export (see export_graph()). */
+        enum struct GraphFormat
+        {
+            PlantUml,
+            Dot
+        };
+
+        /** Snapshot of the runtime counters of a transition (see enable_transition_stats()). */
+        struct TransitionCounters
+        {
+            std::uint64_t count = 0;                                    ///< number of times the transition has been taken
+            std::chrono::nanoseconds average_exit_duration{0};          ///< average duration of the *on exit* function of the previous state
+            std::chrono::nanoseconds average_enter_duration{0};         ///< average duration of the *on enter* function of the next state
+        };
+
+        /** Result of the static analysis of the declared transition graph (see analyze()). */
+        struct Analysis
+        {
+            std::vector<StateId> unreachable_states;                        ///< registered states not reachable from the initial state
+            std::vector<std::pair<StateId, StateId>> dead_overrides;        ///< overridden transitions that can never be taken
+            std::vector<StateId> sinks_without_exit;                        ///< reachable states without outgoing transition nor *on exit* function
+            std::vector<std::vector<StateId>> override_cycles;              ///< chains of transition overrides looping on themselves
+
+            bool empty() const
+            {
+                return unreachable_states.empty() && dead_overrides.empty() && sinks_without_exit.empty() && override_cycles.empty();
+            }
+        };
     
-        /** Register a state handler associated to a state identifier */
+        /** Register a state handler associated to a state identifier 
+         * 
+         * Once the FSM is started, the state handlers table is copied on write: the new version of the table is published atomically, so a
+         * state handler can be overridden from another thread while the FSM is updated. A transition to the state enters the new handler, and
+         * the current state switches to it on the next update, without calling the *on exit* and *on enter* functions: a state is exited by
+         * the handler it was running. The previous handler is released when no one holds it anymore: the tables still using it, and the FSM
+         * while one of its functions is running.
+         * Until the FSM is started, the table is modified in place, so the states must be registered from the thread building the FSM.
+         * 
+         * @note Registering a handler for a lazy state (see register_state_factory()) drops its factory and its entry in the lazy state cache,
+         *       which are not synchronized: it must be done from the thread updating the FSM. Only the handlers of the other states can be
+         *       overridden from another thread.
+         * @throw std::runtime_error if the FSM is sealed and the state identifier is not already registered.
+        */
         template<typename StateIdT, typename... Args>
         void register_state(StateIdT state_id, Args&&... args)
         {
+            register_state_names<StateIdT>();
             //static_assert(std::is_base_of<GameState, StateT>::value, "State must derive from GameState");
+            if (sealed && !is_registered(StateId(state_id)))
+                throw std::runtime_error("Fsm is sealed");
+
             auto state = std::make_shared<State>(std::forward<Args>(args)...);
-            state_handlers_list[StateId(state_id)] = state;
+            forget_state_factory(StateId(state_id));
+            publish_state_handlers([&](StateHandlersTable& handlers) { handlers[StateId(state_id)] = state; });
+        }
+
+        /** Register a state handler associated to a state identifier, with the period of the updates while the state is active.
+         * 
+         * The period is used by a scheduler (see FsmScheduler) to update the FSM only when it is due. The FSM itself does not enforce it.
+         * 
+         * @throw std::runtime_error if the FSM is sealed and the state identifier is not already registered.
+        */
+        template<typename StateIdT, typename... Args>
+        void register_state(StateIdT state_id, UpdatePeriod update_period, Args&&... args)
+        {
+            register_state_names<StateIdT>();
+            if (sealed && !is_registered(StateId(state_id)))
+                throw std::runtime_error("Fsm is sealed");
+
+            auto state = std::make_shared<State>(std::forward<Args>(args)...);
+            state->update_period = update_period.period;
+            forget_state_factory(StateId(state_id));
+            publish_state_handlers([&](StateHandlersTable& handlers) { handlers[StateId(state_id)] = state; });
+        }
+
+        /** Register a lazy state: its state handler is built by a factory the first time the state is entered.
+         * 
+         * The factory is called on the first entry of the state (transition or start), or on the first find_state() of the state. The built
+         * handler is kept in the state handlers table until it is evicted by the lazy state cache (see set_lazy_state_cache_capacity()).
+         * Registering a factory for a state with a built handler drops the handler: it is rebuilt by the new factory on the next entry.
+         * 
+         * @note The lazy states must be registered from the thread updating the FSM.
+         * @param state_id The state identifier.
+         * @param factory The factory building the state handler.
+         * @param has_on_exit True if the built handler has an *on exit* function. The factory is never called by analyze(), which relies on
+         *                    this declaration, whether the state is built or not.
+         * @throw std::runtime_error if the FSM is sealed and the state identifier is not already registered.
+        */
+        template<typename StateIdT>
+        void register_state_factory(StateIdT state_id, StateFactory factory, bool has_on_exit = true)
+        {
+            register_state_names<StateIdT>();
+            auto id = StateId(state_id);
+            if (sealed && !is_registered(id))
+                throw std::runtime_error("Fsm is sealed");
+
+            forget_state_factory(id);
+            auto& ext = extension();
+            ext.state_factories[id] = std::move(factory);
+            if (!has_on_exit)
+                ext.lazy_states_without_exit.insert(id);
+
+            if (find_handler(state_handlers_list.load(std::memory_order_acquire), id))
+                publish_state_handlers([id](StateHandlersTable& handlers) { handlers.erase(id); });
+        }
+
+        /** Bound the number of built lazy states.
+         * 
+         * When a lazy state is built beyond the capacity, the least recently entered lazy states are evicted from the state handlers
+         * table (except the current state), and rebuilt by their factory on their next entry. A state evicted by a nested transition
+         * while one of its functions runs is released when this function returns.
+         * 
+         * @param capacity The maximum number of built lazy states, 0 for no limit (default).
+         */
+        void set_lazy_state_cache_capacity(std::size_t capacity)
+        {
+            if (!extensions && capacity == 0)
+                return;
+            extension().lazy_state_cache_capacity = capacity;
+            evict_lazy_states();
+        }
+
+        /** Get the number of built lazy states. */
+        std::size_t lazy_states_count() const { return extension_view().lazy_states_positions.size(); }
+
+        /** Declare a transition from a state to another state.
+         * 
+         * The declaration is optional and has no effect on the runtime behavior of the FSM: the transitions are still initiated by the state functions.
+         * It allows the FSM to build its transition graph in order to analyze it (see analyze() and prune_unreachable_states()).
+         * 
+         * @param from_state_id The state identifier of the source state.
+         * @param to_state_id The state identifier of the destination state.
+         * @throw std::runtime_error if the FSM is sealed.
+         */
+        template <typename StateIdT1, typename StateIdT2>
+        void declare_transition(StateIdT1 from_state_id, StateIdT2 to_state_id)
+        {
+            if (sealed)
+                throw std::runtime_error("Fsm is sealed");
+
+            auto& targets = extension().declared_transitions[StateId(from_state_id)];
+            if (std::find(targets.begin(), targets.end(), StateId(to_state_id)) == targets.end())
+                targets.push_back(StateId(to_state_id));
+        }
+
+        /** Declare a state without outgoing transition (final state).
+         * 
+         * As declare_transition(), the declaration has no effect on the runtime behavior of the FSM. It tells that the transitions of the
+         * state are all declared, none, which prune_unreachable_states() requires for the reachable states.
+         * 
+         * @param state_id The state identifier of the final state.
+         * @throw std::runtime_error if the FSM is sealed.
+         */
+        template <typename StateIdT>
+        void declare_final_state(StateIdT state_id)
+        {
+            if (sealed)
+                throw std::runtime_error("Fsm is sealed");
+
+            extension().declared_transitions.try_emplace(StateId(state_id));
+        }
+
+        /** Declare a guarded transition from a state to another state.
+         * 
+         * Unlike an unguarded declaration, a guarded transition is taken by the FSM itself: on each update, after the *on do* function
+         * of the source state, the guards of the transitions declared from the current state are evaluated in declaration order and the
+         * transition of the first guard returning true is initiated (transition overrides apply).
+         * The guards are not evaluated if the *on do* function has already initiated a transition or exited the FSM.
+         * 
+         * @param from_state_id The state identifier of the source state.
+         * @param to_state_id The state identifier of the destination state.
+         * @param guard The predicate enabling the transition.
+         * @throw std::runtime_error if the FSM is sealed.
+         */
+        template <typename StateIdT1, typename StateIdT2>
+        void declare_transition(StateIdT1 from_state_id, StateIdT2 to_state_id, std::function<bool()> guard)
+        {
+            declare_transition(from_state_id, to_state_id);
+            extension().guarded_transitions[StateId(from_state_id)].push_back({StateId(to_state_id), std::move(guard)});
         }
     
         /** Set the initial state of the FSM */
         template<typename StateIdT>
         void set_initial_state(StateIdT initial_state_id)
         {
+            register_state_names<StateIdT>();
             current_state_handler = nullptr;
+            if (extensions)
+                extensions->regions_started = false;
             m_current_state_id = StateId(initial_state_id);
+            m_initial_state_id = m_current_state_id;
         }
 
         /** Initiate a transistion to a state.
@@ -336,6 +668,68 @@ namespace std {
             auto state_id = StateId(next_state_id);
             transition_to_state_id(state_id);
         }
+
+        /** Transition resolved by prepare_transition(), to be taken repeatedly with take_prepared_transition()
+         *  without looking up its transition override and its state handler again. */
+        struct PreparedTransition
+        {
+            std::uint64_t fsm_id = 0;                   ///< instance_id() of the machine the transition is resolved for, 0 if not resolved yet
+            StateId from_state_id;                      ///< source state of the transition
+            StateId requested_state_id;                 ///< destination state, before transition override
+            StateId to_state_id;                        ///< destination state, after transition override
+            std::shared_ptr<State> state;               ///< handler of the destination state, null for a lazy state (built on entry)
+            std::uint64_t handlers_version = 0;         ///< version of the state handlers table the handler was resolved from
+            std::uint64_t overrides_version = 0;        ///< version of the transition overrides the destination was resolved from
+        };
+
+        /** Resolve the transition override and the state handler of a transition once, to take it later with take_prepared_transition().
+         * 
+         * @param from_state_id The state identifier of the source state.
+         * @param to_state_id The state identifier of the destination state, before transition override.
+         * @return The prepared transition.
+         */
+        template <typename StateIdT1, typename StateIdT2>
+        PreparedTransition prepare_transition(StateIdT1 from_state_id, StateIdT2 to_state_id) const
+        {
+            PreparedTransition transition;
+            transition.fsm_id = m_instance_id;
+            transition.from_state_id = StateId(from_state_id);
+            transition.requested_state_id = StateId(to_state_id);
+            transition.to_state_id = find_transition_override(transition.from_state_id, transition.requested_state_id);
+
+            // The version is read before the table: a table published in between is detected as a newer version
+            transition.handlers_version = state_handlers_version();
+            transition.overrides_version = overrides_version;
+            if (!is_lazy(transition.to_state_id))
+                transition.state = find_handler(state_handlers_list.load(std::memory_order_acquire), transition.to_state_id);
+
+            return transition;
+        }
+
+        /** Take a prepared transition if the FSM is in its source state.
+         * 
+         * The transition is resolved again if it was prepared for another FSM (compared by instance_id(), so a FSM created at the address
+         * of a destroyed one does not reuse its transitions), or if the state handlers table or the transition overrides changed since it
+         * was prepared. A lazy destination state is entered as with transition_to().
+         * 
+         * @param transition The prepared transition, updated if it is resolved again.
+         * @return True if the transition was taken, false if the FSM is not in the source state of the transition.
+         * @throw std::runtime_error if the destination state is not registered.
+         */
+        bool take_prepared_transition(PreparedTransition& transition)
+        {
+            if (!(m_current_state_id == transition.from_state_id))
+                return false;
+
+            if (transition.fsm_id != m_instance_id || transition.handlers_version != state_handlers_version() || transition.overrides_version != overrides_version)
+                transition = prepare_transition(transition.from_state_id, transition.requested_state_id);
+
+            if (transition.state)
+                enter_state(transition.to_state_id, transition.state);
+            else
+                transition_to_state_id(transition.requested_state_id);
+            return true;
+        }
     
         /** Update the FSM by calling the update function of the current state. 
          * 
@@ -344,20 +738,66 @@ namespace std {
         */
         bool update()
         {
+            refresh_state_handlers();
+            switch_current_state_handler();
+
+            // A single pointer test for all the opt-in features when none is used
+            auto* ext = extensions.get();
+            if (ext && ext->telemetry_slot)
+                ext->telemetry_writer.count_update(*ext->telemetry_slot);
+
             if (current_state_handler)
             {
-                if (current_state_handler->on_do)
-                    current_state_handler->on_do();
+                auto state_id = m_current_state_id;
+
+                // Held while its do function runs: a transition started by the do function replaces the current handler
+                auto handler = current_state_handler;
+                if (handler->on_do)
+                    handler->on_do();
                 else
-                    throw std::runtime_error("No 'do' function defined for state " + current_state_handler->name);
+                    throw std::runtime_error("No 'do' function defined for state " + state_name(state_id));
+
+                if (ext && !ext->guarded_transitions.empty() && m_current_state_id == state_id)
+                    take_guarded_transition(state_id);
             }
+
+            if (ext && !ext->regions.empty() && !is_exit())
+                update_regions();
             
             return !is_exit();
         }
+
+        /** Get the identifier of the current state.
+         * 
+         * @return The current state identifier, the initial state identifier if the FSM is not started.
+         */
+        StateId current_state_id() const { return m_current_state_id; }
+
+        /** Get the update period of the current state.
+         * 
+         * @return The update period declared at the registration of the current state, 0 if none or if the FSM is not started.
+         */
+        std::chrono::nanoseconds current_update_period() const
+        {
+            return current_state_handler ? current_state_handler->update_period : std::chrono::nanoseconds(0);
+        }
+
+        /** Get the number of transitions taken since the FSM was created (the start and the exit are not transitions). */
+        std::uint64_t transitions_count() const { return transitions_counter; }
+
+        /** Check if the FSM is in a given state.
+         * 
+         * @param state_id The state identifier to compare with the current state.
+         * @return True if the current state is the provided one, false otherwise.
+         */
+        template <typename StateIdT>
+        bool is_in_state(StateIdT state_id) const { return m_current_state_id == StateId(state_id); }
     
         /** Start the FSM.
          * 
-         * This call will trigger the enter behavior of the initial state.
+         * This call will trigger the enter behavior of the initial state, then start the regions.
+         * An exited FSM is restarted by setting its initial state again, its exited regions restarting from their own initial state.
+         * A FSM made of regions only, which has no initial state to set, restarts with its regions.
          * 
          * @throw std::runtime_error if the FSM is already started.
          * @throw std::runtime_error if no initial state is set.
@@ -367,22 +807,37 @@ namespace std {
         {
 
 
-            if (current_state_handler) 
+            if (current_state_handler || (extensions && extensions->regions_started)) 
                 throw std::runtime_error("Fsm already started");
 
+            state_handlers_shared.store(true, std::memory_order_release);
+            unshared_state_handlers.reset();
+
+            if (is_exit() && m_initial_state_id == StateId(InternalState::None) && regions_count() > 0)
+                m_current_state_id = StateId(InternalState::None);
+
             if (m_current_state_id == StateId(InternalState::None))
-                throw std::runtime_error("No initial state set");
+            {
+                if (regions_count() == 0)
+                    throw std::runtime_error("No initial state set");
 
-            auto it = state_handlers_list.find(m_current_state_id);
-            if (it == state_handlers_list.end())
+                start_regions();
+                return;
+            }
+
+            auto state = find_or_build_handler(m_current_state_id);
+            if (!state)
             {
-                throw std::runtime_error("State not registered");
+                throw std::runtime_error("State not registered: " + state_name(m_current_state_id));
             }
             
-            current_state_handler = it->second;
+            current_state_handler = state;
+            publish_telemetry();
 
-            if (current_state_handler->on_enter)
-                current_state_handler->on_enter();
+            if (state->on_enter)
+                state->on_enter();
+
+            start_regions();
         }
 
 
@@ -392,11 +847,24 @@ namespace std {
          */
         void exit()
         {
-            if (current_state_handler && current_state_handler->on_exit)
-                current_state_handler->on_exit();
+            if (extensions)
+            {
+                for (auto& [region_id, region] : extensions->regions)
+                {
+                    if (!region->is_exit())
+                        region->exit();
+                }
+            }
+
+            auto exited = current_state_handler;
+            if (exited && exited->on_exit)
+                exited->on_exit();
 
             current_state_handler = nullptr;
             m_current_state_id = StateId(InternalState::Exit);
+            if (extensions)
+                extensions->regions_started = false;
+            publish_telemetry();
 
         }
 
@@ -424,7 +892,11 @@ namespace std {
         template <typename StateIdT1, typename StateIdT2, typename StateIdT3>
         void transition_override(StateIdT1 prev_state_id, StateIdT2 next_state_id, StateIdT3 new_next_state_id)
         {
+            if (sealed)
+                throw std::runtime_error("Fsm is sealed");
+
             transitions_override_list[std::make_pair(StateId(prev_state_id), StateId(next_state_id))] = StateId(new_next_state_id);
+            ++overrides_version;
         }
 
         /** Attempts to find a state handler associated to the provided state id.
@@ -433,51 +905,684 @@ namespace std {
          * It could be useful in the case of FSM customization by state overriding, but the overriding state want to execute the original state behavior.
          * 
          * @param state_id The state identifier to search for.
+         * A lazy state is built by its factory if it is not built yet.
+         * 
          * @return A shared pointer to the state handler if found, otherwise an empty optional.
          */
         template <typename StateIdT>
         std::optional<std::shared_ptr<State>> find_state(StateIdT state_id)
         {
             
-            auto it = state_handlers_list.find(StateId(state_id));
-            if (it != state_handlers_list.end())
+            auto state = find_handler(state_handlers_list.load(std::memory_order_acquire), StateId(state_id));
+            if (!state && is_lazy(StateId(state_id)))
+                state = find_or_build_handler(StateId(state_id));
+            if (state)
             {
-                return it->second;
+                return state;
             }
             return std::nullopt;
         }
 
+        /** Get the version of the state handlers table.
+         * 
+         * The version is incremented each time the table is modified (state registration, state handler override or pruning).
+         * 
+         * @return The version of the state handlers table.
+         */
+        std::uint64_t state_handlers_version() const { return state_handlers_version_counter.load(std::memory_order_acquire); }
+
+        /** Get the identifier of the FSM, unique in the process and never reused, even by a FSM created at the address of a destroyed one. */
+        std::uint64_t instance_id() const { return m_instance_id; }
+
+        /** Analyze the transition graph built from the declared transitions and the transition overrides.
+         * 
+         * The graph is walked from the current state and from the initial state, as the FSM may be restarted. A declared transition 
+         * which is overridden is replaced by the transition to the overriding state. The analysis reports:
+         * 
+         *  - the registered states that are not reachable,
+         *  - the transition overrides that never fire, because their previous state is not reachable or does not declare the overridden transition,
+         *  - the reachable states that declare no transition (sink states) and that have no *on exit* function, as declared at registration
+         *    for the lazy states (see register_state_factory()), so that the report does not depend on the lazy states built at that time,
+         *  - the cycles made of transition overrides only (each state overriding toward the next one, the last one toward the first one).
+         * 
+         * @note States that declare no transition are considered as sink states. The analysis is therefore only relevant when all transitions are declared.
+         * @return The analysis report.
+         * @throw std::runtime_error if no initial state is set.
+         */
+        Analysis analyze() const
+        {
+            Analysis analysis;
+            auto reachable = find_reachable_states();
+            auto handlers = state_handlers_list.load(std::memory_order_acquire);
+            const auto& ext = extension_view();
+
+            for (const auto& [state_id, state] : table_of(handlers))
+            {
+                // The built lazy states are analyzed with the other lazy states, from their registration
+                if (ext.state_factories.find(state_id) != ext.state_factories.end())
+                    continue;
+
+                if (reachable.find(state_id) == reachable.end())
+                {
+                    analysis.unreachable_states.push_back(state_id);
+                }
+                else if (!state->on_exit && !declares_transitions(state_id))
+                {
+                    analysis.sinks_without_exit.push_back(state_id);
+                }
+            }
+
+            for (const auto& [state_id, factory] : ext.state_factories)
+            {
+                if (reachable.find(state_id) == reachable.end())
+                {
+                    analysis.unreachable_states.push_back(state_id);
+                }
+                else if (ext.lazy_states_without_exit.find(state_id) != ext.lazy_states_without_exit.end() && !declares_transitions(state_id))
+                {
+                    analysis.sinks_without_exit.push_back(state_id);
+                }
+            }
+
+            for (const auto& [transition, new_next_state_id] : transitions_override_list)
+            {
+                if (is_dead_override(transition, reachable))
+                    analysis.dead_overrides.push_back(transition);
+            }
+
+            analysis.override_cycles = find_override_cycles();
+
+            return analysis;
+        }
+
+        /** Drop the state handlers that are not reachable, and the transition overrides that never fire.
+         * 
+         * The reachability is the one reported by analyze(). The current state and the initial state are never dropped.
+         * The reachability only follows the declared transitions: each reachable registered state must have declared its transitions
+         * (declare_transition(), or declare_final_state() for a state without outgoing transition), otherwise the states it leads to would
+         * be wrongly dropped and nothing is pruned. When nothing is unreachable, the state handlers table is not modified.
+         * 
+         * @return The number of dropped state handlers.
+         * @throw std::runtime_error if no initial state is set, or if a reachable registered state has no declared transition.
+         */
+        std::size_t prune_unreachable_states()
+        {
+            const auto& declared_transitions = extension_view().declared_transitions;
+            for (const auto& state_id : find_reachable_states())
+            {
+                if (is_registered(state_id) && declared_transitions.find(state_id) == declared_transitions.end())
+                    throw std::runtime_error("Cannot prune the fsm: the transitions of the state " + state_name(state_id) + " are not declared");
+            }
+
+            auto analysis = analyze();
+
+            for (const auto& transition : analysis.dead_overrides)
+                transitions_override_list.erase(transition);
+            if (!analysis.dead_overrides.empty())
+                ++overrides_version;
+
+            if (analysis.unreachable_states.empty())
+                return 0;
+
+            publish_state_handlers([&analysis](StateHandlersTable& handlers)
+            {
+                for (const auto& state_id : analysis.unreachable_states)
+                    handlers.erase(state_id);
+            });
+
+            for (const auto& state_id : analysis.unreachable_states)
+            {
+                if (extensions)
+                {
+                    extensions->declared_transitions.erase(state_id);
+                    extensions->guarded_transitions.erase(state_id);
+                }
+                forget_state_factory(state_id);
+            }
+
+            return analysis.unreachable_states.size();
+        }
+
+        /** Enable or disable the runtime counters of the transitions.
+         * 
+         * When enabled, each transition counts the number of times it has been taken and measures the duration of the *on exit* 
+         * function of the previous state and of the *on enter* function of the next state. The counters are disabled by default.
+         * 
+         * @note The counters must be enabled before they are read from another thread (find_transition_stats(), export_graph()).
+         * @param enabled True to enable the counters, false to disable them. The counters already collected are kept.
+         */
+        void enable_transition_stats(bool enabled = true)
+        {
+            if (extensions || enabled)
+                extension().transition_stats_enabled = enabled;
+        }
+
+        /** Attempts to find the runtime counters of a transition.
+         * 
+         * @param from_state_id The state identifier of the previous state.
+         * @param to_state_id The state identifier of the next state, after transition override.
+         * @return The counters of the transition if it has been taken while the counters were enabled, otherwise an empty optional.
+         */
+        template <typename StateIdT1, typename StateIdT2>
+        std::optional<TransitionCounters> find_transition_stats(StateIdT1 from_state_id, StateIdT2 to_state_id) const
+        {
+            const auto& ext = extension_view();
+            std::lock_guard<std::mutex> lock(ext.transitions_stats_mutex);
+
+            auto it = ext.transitions_stats.find(std::make_pair(StateId(from_state_id), StateId(to_state_id)));
+            if (it == ext.transitions_stats.end())
+                return std::nullopt;
+
+            return it->second->snapshot();
+        }
+
+        /** Export the transition graph of the FSM as a PlantUML or DOT diagram.
+         * 
+         * The diagram is built from the registered states, the declared transitions, the transition overrides and the transitions
+         * taken at runtime while the transition counters were enabled. The taken transitions are annotated with their counters.
+         * 
+         * The export can be called from another thread while the FSM is updated: the counters are read without pausing the FSM.
+         * It must not be called while states are registered, or transitions declared or overridden.
+         * 
+         * @param format The output format.
+         * @return The diagram source.
+         */
+        std::string export_graph(GraphFormat format = GraphFormat::PlantUml) const
+        {
+            std::ostringstream out;
+            std::unordered_set<StateId> states;
+            std::vector<std::pair<std::pair<StateId, StateId>, std::string>> edges;
+
+            auto add_edge = [&edges, &states](StateId from, StateId to, std::string label)
+            {
+                states.insert(from);
+                states.insert(to);
+                auto it = std::find_if(edges.begin(), edges.end(), [&](const auto& edge) { return edge.first == std::make_pair(from, to); });
+                if (it == edges.end())
+                    edges.emplace_back(std::make_pair(from, to), std::move(label));
+                else if (!label.empty())
+                    it->second = std::move(label);
+            };
+
+            const auto& ext = extension_view();
+            auto handlers = state_handlers_list.load(std::memory_order_acquire);
+            for (const auto& [state_id, state] : table_of(handlers))
+                states.insert(state_id);
+            for (const auto& [state_id, factory] : ext.state_factories)
+                states.insert(state_id);
+
+            for (const auto& [from, targets] : ext.declared_transitions)
+                for (const auto& to : targets)
+                    add_edge(from, find_transition_override(from, to), "");
+
+            for (const auto& [transition, new_next_state_id] : transitions_override_list)
+                add_edge(transition.first, new_next_state_id, "");
+
+            {
+                std::lock_guard<std::mutex> lock(ext.transitions_stats_mutex);
+                for (const auto& [transition, stats] : ext.transitions_stats)
+                    add_edge(transition.first, transition.second, format_counters(stats->snapshot()));
+            }
+
+            const bool dot = format == GraphFormat::Dot;
+            out << (dot ? "digraph fsm {\n" : "@startuml\n");
+
+            for (const auto& state_id : states)
+            {
+                if (dot)
+                    out << "  " << graph_node_name(state_id) << " [label=\"" << state_name(state_id) << "\"];\n";
+                else
+                    out << "state \"" << state_name(state_id) << "\" as " << graph_node_name(state_id) << "\n";
+            }
+
+            if (!dot && m_initial_state_id != StateId(InternalState::None))
+                out << "[*] --> " << graph_node_name(m_initial_state_id) << "\n";
+
+            for (const auto& [edge, label] : edges)
+            {
+                out << (dot ? "  " : "") << graph_node_name(edge.first) << (dot ? " -> " : " --> ") << graph_node_name(edge.second);
+                if (!label.empty())
+                    out << (dot ? " [label=\"" + label + "\"]" : " : " + label);
+                out << (dot ? ";\n" : "\n");
+            }
+
+            out << (dot ? "}\n" : "@enduml\n");
+            return out.str();
+        }
+
+        /** Get an orthogonal region of the FSM, created on the first call.
+         * 
+         * A region is a sub-machine with its own states, current state and transition overrides. It is started, updated and exited
+         * with the FSM (see start(), update() and exit()). Its states and initial state are registered on the returned sub-machine.
+         * 
+         * @param region_id The region identifier, an enum value.
+         * @return The sub-machine of the region.
+         * @throw std::runtime_error if the region does not exist and the FSM is already started.
+         */
+        template <typename RegionIdT>
+        Fsm& region(RegionIdT region_id)
+        {
+            auto id = StateId(region_id);
+            if (extensions)
+            {
+                for (auto& [existing_id, existing_region] : extensions->regions)
+                {
+                    if (existing_id == id)
+                        return *existing_region;
+                }
+            }
+
+            if (current_state_handler || (extensions && extensions->regions_started))
+                throw std::runtime_error("Cannot add a region to a started Fsm");
+
+            auto& regions = extension().regions;
+            regions.emplace_back(id, std::make_unique<Fsm>());
+            return *regions.back().second;
+        }
+
+        /** Get the number of orthogonal regions of the FSM. */
+        std::size_t regions_count() const { return extensions ? extensions->regions.size() : 0; }
+
+        /** Update the orthogonal regions in parallel on a thread pool.
+         * 
+         * The regions must be independent: a region must not access the other regions, nor data shared without synchronization.
+         * 
+         * @param pool The thread pool (see ThreadPool), which must outlive the FSM, or nullptr to update the regions sequentially (default).
+         */
+        template <typename ThreadPoolT>
+        void set_region_thread_pool(ThreadPoolT* pool)
+        {
+            if (!pool)
+                return set_region_thread_pool(nullptr);
+
+            extension().submit_region_update = [pool](std::function<bool()> update) { return pool->submit(std::move(update)); };
+        }
+
+        /** Update the orthogonal regions sequentially (default). */
+        void set_region_thread_pool(std::nullptr_t)
+        {
+            if (extensions)
+                extensions->submit_region_update = nullptr;
+        }
+
+        /** Seal the FSM.
+         * 
+         * Once sealed, registering a new state, declaring a transition or overriding a transition throws an exception.
+         * Overriding the handler of an already registered state is still allowed.
+         */
+        void seal() { sealed = true; }
+
+        /** Check if the FSM is sealed.
+         * 
+         * @return True if the FSM is sealed, false otherwise.
+         */
+        bool is_sealed() const { return sealed; }
+
+        /** Attach a telemetry slot, in which the FSM publishes its current state and counters.
+         * 
+         * The current state is published at once, then at each transition. The slot is written by the thread of the FSM only.
+         * 
+         * @param slot The slot (see FsmTelemetrySlot), which must stay mapped while attached (the FSM frees it on destruction), or nullptr to
+         *             detach the current slot.
+         * @param on_release Called once when the FSM frees the slot (detach, replacement or destruction), e.g. by its owner to stop tracking the FSM.
+         */
+        template <typename TelemetrySlotT>
+        void set_telemetry_slot(TelemetrySlotT* slot, std::function<void()> on_release = nullptr)
+        {
+            static_assert(std::is_same_v<TelemetrySlotT, FsmTelemetrySlot>, "The telemetry slot must be a FsmTelemetrySlot");
+
+            release_telemetry_slot();
+            if (!slot)
+                return;
+
+            // The slot is written through functions bound here, where its type is complete
+            auto& ext = extension();
+            ext.telemetry_slot = slot;
+            ext.telemetry_slot_released = std::move(on_release);
+            ext.telemetry_writer.publish = [](FsmTelemetrySlot& written, StateId state_id)
+            {
+                static_cast<TelemetrySlotT&>(written).publish(state_id.value(), state_id.name());
+            };
+            ext.telemetry_writer.count_update = [](FsmTelemetrySlot& written) { static_cast<TelemetrySlotT&>(written).count_update(); };
+            ext.telemetry_writer.detach = [](FsmTelemetrySlot& written) { static_cast<TelemetrySlotT&>(written).detach(); };
+
+            slot->attach(m_current_state_id.value(), m_current_state_id.name());
+        }
+
+        /** Detach the current telemetry slot. */
+        void set_telemetry_slot(std::nullptr_t) { release_telemetry_slot(); }
+
+        /** Get the attached telemetry slot, nullptr if none. */
+        FsmTelemetrySlot* get_telemetry_slot() const { return extensions ? extensions->telemetry_slot : nullptr; }
+
     protected:
 
 
+        void start_regions()
+        {
+            if (!extensions)
+                return;
+
+            for (auto& [region_id, region] : extensions->regions)
+            {
+                // A region exited with the FSM restarts from its initial state
+                if (region->is_exit())
+                    region->set_initial_state(region->m_initial_state_id);
+                region->start();
+            }
+            extensions->regions_started = !extensions->regions.empty();
+        }
+
+        /* Update the regions, sequentially or in parallel, then exit the whole FSM if a region has exited */
+        void update_regions()
+        {
+            auto& regions_list = extensions->regions;
+            if (extensions->submit_region_update && regions_list.size() > 1)
+            {
+                std::vector<std::future<bool>> updates;
+                updates.reserve(regions_list.size() - 1);
+                for (std::size_t i = 1; i < regions_list.size(); ++i)
+                    updates.push_back(extensions->submit_region_update([region = regions_list[i].second.get()]() { return region->update(); }));
+
+                // The first region is updated by the calling thread, while the others are updated by the pool.
+                // All the updates are waited for before rethrowing the first exception.
+                std::exception_ptr error;
+                try { regions_list.front().second->update(); } catch (...) { error = std::current_exception(); }
+
+                for (auto& update : updates)
+                {
+                    try { update.get(); } catch (...) { if (!error) error = std::current_exception(); }
+                }
+
+                if (error)
+                    std::rethrow_exception(error);
+            }
+            else
+            {
+                for (auto& [region_id, region] : regions_list)
+                    region->update();
+            }
+
+            for (auto& [region_id, region] : regions_list)
+            {
+                if (region->is_exit())
+                {
+                    exit();
+                    break;
+                }
+            }
+        }
+
         void transition_to_state_id(StateId state_id)
         {
             state_id = find_transition_override(m_current_state_id, state_id);
-            
-            auto it = state_handlers_list.find(state_id);
-            if (it == state_handlers_list.end())
+
+            auto state = find_or_build_handler(state_id);
+            if (!state)
             {
-                throw std::runtime_error("State not registered");
+                throw std::runtime_error("State not registered: " + state_name(state_id));
             } 
 
+            enter_state(state_id, std::move(state));
+        }
+
+        /* Switch to a state whose handler is already resolved: exit the current state, then enter the new one.
+           The exited and entered handlers are held while their function runs, as it may start another transition (replacing the current
+           handler), and a handler swapped or evicted meanwhile would be released. */
+        void enter_state(StateId state_id, std::shared_ptr<State> state)
+        {
+            if (extensions)
+                return enter_state_observed(state_id, std::move(state));
+
             m_current_state_id = state_id;
+            ++transitions_counter;
+
+            auto exited = current_state_handler;
+            if (exited && exited->on_exit)
+                exited->on_exit();
+
+            current_state_handler = state;
+
+            if (state && state->on_enter)
+                state->on_enter();
+        }
+
+        /* Same as enter_state(), publishing the transition in the telemetry slot and measuring it in the transition counters, if enabled */
+        void enter_state_observed(StateId state_id, std::shared_ptr<State> state)
+        {
+            auto prev_state_id = m_current_state_id;
+            m_current_state_id = state_id;
+            ++transitions_counter;
+            publish_telemetry();
+
+            TransitionStats* stats = extensions->transition_stats_enabled ? find_or_create_transition_stats(prev_state_id, state_id) : nullptr;
+            auto exit_start = stats ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
             
-            if (current_state_handler && current_state_handler->on_exit)
-                current_state_handler->on_exit();
-            
-            current_state_handler = it->second;
+            auto exited = current_state_handler;
+            if (exited && exited->on_exit)
+                exited->on_exit();
 
+            auto enter_start = stats ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
             
+            current_state_handler = state;
+
+            if (state && state->on_enter)
+                state->on_enter();
 
-            if (current_state_handler && current_state_handler->on_enter)
-                current_state_handler->on_enter();
+            if (stats)
+                stats->record(enter_start - exit_start, std::chrono::steady_clock::now() - enter_start);
         }
 
     private:
 
 
+        using StateHandlersTable = std::unordered_map<StateId, std::shared_ptr<State>>;
+
+        /* Register the names of the enumerators of the type of a state identifier, for StateId::name() */
+        template <typename StateIdT>
+        static void register_state_names()
+        {
+            if constexpr (std::is_enum_v<StateIdT>)
+                StateId::register_names<StateIdT>();
+        }
+
+        /* Free the telemetry slot, then notify its owner. The callback is moved out first: it may attach another slot. */
+        void release_telemetry_slot()
+        {
+            if (!extensions || !extensions->telemetry_slot)
+                return;
+
+            extensions->telemetry_writer.detach(*extensions->telemetry_slot);
+            extensions->telemetry_slot = nullptr;
+
+            auto released = std::move(extensions->telemetry_slot_released);
+            extensions->telemetry_slot_released = nullptr;
+            if (released)
+                released();
+        }
+
+        /* Copy the published state handlers table, apply the modification on the copy and publish it. 
+           Concurrent writers retry on the latest version. The previous version is released by its last reader.
+           Until the FSM is started, the table is only used by the thread building the FSM and is modified in place instead,
+           so registering N states costs O(N) rather than N copies of the table. */
+        template <typename Modification>
+        void publish_state_handlers(Modification modification)
+        {
+            if (!state_handlers_shared.load(std::memory_order_acquire))
+            {
+                if (!unshared_state_handlers)
+                {
+                    unshared_state_handlers = std::make_shared<StateHandlersTable>();
+                    state_handlers_list.store(unshared_state_handlers, std::memory_order_release);
+                }
+                modification(*unshared_state_handlers);
+                state_handlers_version_counter.fetch_add(1, std::memory_order_release);
+                return;
+            }
+
+            auto handlers = state_handlers_list.load(std::memory_order_acquire);
+            std::shared_ptr<const StateHandlersTable> new_handlers;
+
+            do
+            {
+                auto copy = handlers ? std::make_shared<StateHandlersTable>(*handlers) : std::make_shared<StateHandlersTable>();
+                modification(*copy);
+                new_handlers = std::move(copy);
+            } 
+            while (!state_handlers_list.compare_exchange_weak(handlers, new_handlers, std::memory_order_acq_rel, std::memory_order_acquire));
+
+            state_handlers_version_counter.fetch_add(1, std::memory_order_release);
+        }
+
+        /* Take the latest version of the state handlers table if it changed.
+           It costs a single lock-free load of the version when the table did not change; loading the table itself may take the internal
+           lock of std::atomic<std::shared_ptr> (libstdc++). */
+        void refresh_state_handlers()
+        {
+            auto version = state_handlers_version_counter.load(std::memory_order_acquire);
+            if (version == m_state_handlers_version)
+                return;
+
+            m_state_handlers = state_handlers_list.load(std::memory_order_acquire);
+            m_state_handlers_version = version;
+        }
+
+        /* Switch the current state to its handler in the snapshot, if the snapshot changed since the last switch.
+           Only done at the start of an update, so that a state is exited by the handler it was running, even when a transition started by
+           this handler refreshes the snapshot. */
+        void switch_current_state_handler()
+        {
+            if (m_current_handler_version == m_state_handlers_version)
+                return;
+
+            m_current_handler_version = m_state_handlers_version;
+            if (current_state_handler)
+            {
+                if (auto state = find_handler(m_state_handlers, m_current_state_id))
+                    current_state_handler = std::move(state);
+            }
+        }
+
+        /* Find the handler of a state in the snapshot of the FSM thread, building it if the state is lazy and not built yet */
+        std::shared_ptr<State> find_or_build_handler(StateId state_id)
+        {
+            refresh_state_handlers();
+
+            auto state = find_handler(m_state_handlers, state_id);
+            if (!extensions || extensions->state_factories.empty())
+                return state;
+
+            auto factory = extensions->state_factories.find(state_id);
+            if (factory == extensions->state_factories.end())
+                return state;
+
+            if (!state)
+            {
+                state = std::make_shared<State>(factory->second());
+                publish_state_handlers([state_id, &state](StateHandlersTable& handlers) { handlers[state_id] = state; });
+                refresh_state_handlers();
+            }
+
+            // Move the lazy state at the front of the least recently used list
+            auto& lazy_states_lru = extensions->lazy_states_lru;
+            auto position = extensions->lazy_states_positions.find(state_id);
+            if (position != extensions->lazy_states_positions.end())
+                lazy_states_lru.splice(lazy_states_lru.begin(), lazy_states_lru, position->second);
+            else
+                extensions->lazy_states_positions[state_id] = lazy_states_lru.insert(lazy_states_lru.begin(), state_id);
+
+            evict_lazy_states();
+            return state;
+        }
+
+        /* Evict the least recently entered lazy states beyond the cache capacity, except the current state and the most recently entered one.
+           A nested transition can evict a state whose function is still running: update() and enter_state() hold the running handlers, so
+           the evicted handler is only released when its function returns. */
+        void evict_lazy_states()
+        {
+            if (!extensions)
+                return;
+
+            auto& lazy_states_lru = extensions->lazy_states_lru;
+            auto& lazy_states_positions = extensions->lazy_states_positions;
+            auto lazy_state_cache_capacity = extensions->lazy_state_cache_capacity;
+            if (lazy_state_cache_capacity == 0 || lazy_states_positions.size() <= lazy_state_cache_capacity)
+                return;
+
+            std::vector<StateId> evicted;
+            for (auto it = lazy_states_lru.rbegin(); it != lazy_states_lru.rend() && lazy_states_positions.size() - evicted.size() > lazy_state_cache_capacity; ++it)
+            {
+                if (*it != m_current_state_id && std::next(it) != lazy_states_lru.rend())
+                    evicted.push_back(*it);
+            }
+
+            if (evicted.empty())
+                return;
+
+            for (const auto& state_id : evicted)
+            {
+                lazy_states_lru.erase(lazy_states_positions[state_id]);
+                lazy_states_positions.erase(state_id);
+            }
+
+            publish_state_handlers([&evicted](StateHandlersTable& handlers)
+            {
+                for (const auto& state_id : evicted)
+                    handlers.erase(state_id);
+            });
+        }
+
+        /* Drop the factory of a lazy state, and its entry in the least recently used list.
+           A state without factory is only looked up, so that the handlers of the regular states can be registered from another thread. */
+        void forget_state_factory(StateId state_id)
+        {
+            if (!extensions)
+                return;
+
+            auto factory = extensions->state_factories.find(state_id);
+            if (factory == extensions->state_factories.end())
+                return;
+
+            extensions->state_factories.erase(factory);
+            extensions->lazy_states_without_exit.erase(state_id);
+
+            auto position = extensions->lazy_states_positions.find(state_id);
+            if (position != extensions->lazy_states_positions.end())
+            {
+                extensions->lazy_states_lru.erase(position->second);
+                extensions->lazy_states_positions.erase(position);
+            }
+        }
+
+        bool is_lazy(StateId state_id) const
+        {
+            return extensions && extensions->state_factories.find(state_id) != extensions->state_factories.end();
+        }
+
+        bool is_registered(StateId state_id) const
+        {
+            return find_handler(state_handlers_list.load(std::memory_order_acquire), state_id) || is_lazy(state_id);
+        }
+
+        static std::shared_ptr<State> find_handler(const std::shared_ptr<const StateHandlersTable>& handlers, StateId state_id)
+        {
+            if (handlers)
+            {
+                auto it = handlers->find(state_id);
+                if (it != handlers->end())
+                    return it->second;
+            }
+            return nullptr;
+        }
+
+        static const StateHandlersTable& table_of(const std::shared_ptr<const StateHandlersTable>& handlers)
+        {
+            static const StateHandlersTable empty;
+            return handlers ? *handlers : empty;
+        }
+
         /* Check if a transition override exits. If yes, override the "next state id" by the "overriden one"*/
-        StateId find_transition_override(StateId prev_state_id, StateId next_state_id)
+        StateId find_transition_override(StateId prev_state_id, StateId next_state_id) const
         {
             auto it = transitions_override_list.find(std::make_pair(prev_state_id, next_state_id));
             if (it != transitions_override_list.end())
@@ -487,11 +1592,255 @@ namespace std {
             return next_state_id;
         }
 
+        /* Initiate the transition of the first guard returning true, if any */
+        void take_guarded_transition(StateId state_id)
+        {
+            auto it = extensions->guarded_transitions.find(state_id);
+            if (it == extensions->guarded_transitions.end())
+                return;
+
+            for (const auto& transition : it->second)
+            {
+                if (transition.guard && transition.guard())
+                {
+                    transition_to_state_id(transition.to_state_id);
+                    return;
+                }
+            }
+        }
+
+        /* Runtime counters of a transition, readable from another thread while the FSM is running */
+        struct TransitionStats
+        {
+            std::atomic<std::uint64_t> count{0};
+            std::atomic<std::uint64_t> exit_duration_ns{0};
+            std::atomic<std::uint64_t> enter_duration_ns{0};
+
+            void record(std::chrono::nanoseconds exit_duration, std::chrono::nanoseconds enter_duration)
+            {
+                exit_duration_ns.fetch_add(exit_duration.count(), std::memory_order_relaxed);
+                enter_duration_ns.fetch_add(enter_duration.count(), std::memory_order_relaxed);
+                count.fetch_add(1, std::memory_order_release);
+            }
+
+            TransitionCounters snapshot() const
+            {
+                TransitionCounters counters;
+                counters.count = count.load(std::memory_order_acquire);
+                if (counters.count)
+                {
+                    counters.average_exit_duration = std::chrono::nanoseconds(exit_duration_ns.load(std::memory_order_relaxed) / counters.count);
+                    counters.average_enter_duration = std::chrono::nanoseconds(enter_duration_ns.load(std::memory_order_relaxed) / counters.count);
+                }
+                return counters;
+            }
+        };
+
+        /* Only the FSM thread inserts in the list, so the lookup is done without lock. The insertion is locked against the readers. */
+        TransitionStats* find_or_create_transition_stats(StateId prev_state_id, StateId next_state_id)
+        {
+            auto key = std::make_pair(prev_state_id, next_state_id);
+            auto it = extensions->transitions_stats.find(key);
+            if (it != extensions->transitions_stats.end())
+                return it->second.get();
+
+            std::lock_guard<std::mutex> lock(extensions->transitions_stats_mutex);
+            return extensions->transitions_stats.emplace(key, std::make_unique<TransitionStats>()).first->second.get();
+        }
+
+        void publish_telemetry()
+        {
+            if (extensions && extensions->telemetry_slot)
+                extensions->telemetry_writer.publish(*extensions->telemetry_slot, m_current_state_id);
+        }
+
+        /* Name of a state in the diagnostics and the graph export: the enumerator name if known, otherwise a name built on the state identifier */
+        static std::string state_name(StateId state_id)
+        {
+            auto name = state_id.name();
+            return name.empty() ? graph_node_name(state_id) : std::string(name);
+        }
+
+        static std::string graph_node_name(StateId state_id)
+        {
+            return "state_" + std::to_string(static_cast<unsigned int>(state_id.value()));
+        }
+
+        static std::string format_counters(const TransitionCounters& counters)
+        {
+            std::ostringstream out;
+            out << counters.count << "x, exit " << counters.average_exit_duration.count() << "ns, enter " << counters.average_enter_duration.count() << "ns";
+            return out.str();
+        }
+
+        /* Walk the declared transitions (with overrides applied) from the current state and from the initial state */
+        std::unordered_set<StateId> find_reachable_states() const
+        {
+            if (m_current_state_id == StateId(InternalState::None))
+                throw std::runtime_error("No initial state set");
+
+            std::unordered_set<StateId> reachable;
+            std::vector<StateId> to_visit{m_current_state_id};
+            if (m_initial_state_id != StateId(InternalState::None))
+                to_visit.push_back(m_initial_state_id);
+
+            while (!to_visit.empty())
+            {
+                auto state_id = to_visit.back();
+                to_visit.pop_back();
+
+                if (!reachable.insert(state_id).second)
+                    continue;
+
+                auto it = extension_view().declared_transitions.find(state_id);
+                if (it == extension_view().declared_transitions.end())
+                    continue;
+
+                for (const auto& next_state_id : it->second)
+                    to_visit.push_back(find_transition_override(state_id, next_state_id));
+            }
+
+            return reachable;
+        }
+
+        /* True if the state declares at least one outgoing transition */
+        bool declares_transitions(StateId state_id) const
+        {
+            const auto& declared_transitions = extension_view().declared_transitions;
+            auto it = declared_transitions.find(state_id);
+            return it != declared_transitions.end() && !it->second.empty();
+        }
+
+        /* An override is dead if its previous state is unreachable or never declares the overridden transition */
+        bool is_dead_override(const std::pair<StateId, StateId>& transition, const std::unordered_set<StateId>& reachable) const
+        {
+            if (reachable.find(transition.first) == reachable.end())
+                return true;
+
+            const auto& declared_transitions = extension_view().declared_transitions;
+            auto it = declared_transitions.find(transition.first);
+            return it == declared_transitions.end() 
+                || std::find(it->second.begin(), it->second.end(), transition.second) == it->second.end();
+        }
+
+        /* Find the cycles of the graph made of the "previous state -> overriding state" edges only */
+        std::vector<std::vector<StateId>> find_override_cycles() const
+        {
+            std::unordered_map<StateId, std::vector<StateId>> override_edges;
+            for (const auto& [transition, new_next_state_id] : transitions_override_list)
+                override_edges[transition.first].push_back(new_next_state_id);
+
+            enum struct Mark { InProgress, Done };
+            std::unordered_map<StateId, Mark> marks;
+            std::vector<StateId> path;
+            std::vector<std::vector<StateId>> cycles;
+
+            std::function<void(StateId)> visit = [&](StateId state_id)
+            {
+                marks[state_id] = Mark::InProgress;
+                path.push_back(state_id);
+
+                auto it = override_edges.find(state_id);
+                if (it != override_edges.end())
+                {
+                    for (const auto& next_state_id : it->second)
+                    {
+                        auto mark = marks.find(next_state_id);
+                        if (mark == marks.end())
+                            visit(next_state_id);
+                        else if (mark->second == Mark::InProgress)
+                            cycles.emplace_back(std::find(path.begin(), path.end(), next_state_id), path.end());
+                    }
+                }
+
+                path.pop_back();
+                marks[state_id] = Mark::Done;
+            };
+
+            for (const auto& [state_id, next_states] : override_edges)
+            {
+                if (marks.find(state_id) == marks.end())
+                    visit(state_id);
+            }
+
+            return cycles;
+        }
+
         std::shared_ptr<State> current_state_handler;
         StateId m_current_state_id{InternalState::None};
+        StateId m_initial_state_id{InternalState::None};
         
-        std::unordered_map<StateId, std::shared_ptr<State>> state_handlers_list;
+        std::atomic<std::shared_ptr<const StateHandlersTable>> state_handlers_list;
+        std::atomic<std::uint64_t> state_handlers_version_counter{0};
+        std::atomic<bool> state_handlers_shared{false};                 // set by start(): the table is copied on write from then on
+        std::shared_ptr<StateHandlersTable> unshared_state_handlers;    // published table, modified in place until the FSM is started
+
+        /* Snapshot of the state handlers table used by the FSM thread, refreshed when the version changes */
+        std::shared_ptr<const StateHandlersTable> m_state_handlers;
+        std::uint64_t m_state_handlers_version = 0;
+        std::uint64_t m_current_handler_version = 0;                    // version of the snapshot the current handler was switched to
         std::unordered_map<std::pair<StateId, StateId>, StateId> transitions_override_list;
+        std::uint64_t overrides_version = 0;
+
+        /* Identifier unique in the process, never reused: unlike the address, it distinguishes a FSM from a destroyed one */
+        static inline std::atomic<std::uint64_t> last_instance_id{0};
+        const std::uint64_t m_instance_id = last_instance_id.fetch_add(1, std::memory_order_relaxed) + 1;
+        bool sealed = false;
+        std::uint64_t transitions_counter = 0;
+
+        struct GuardedTransition
+        {
+            StateId to_state_id;
+            std::function<bool()> guard;
+        };
+
+        /* Functions writing the telemetry slot, bound by set_telemetry_slot() */
+        struct TelemetryWriter
+        {
+            void (*publish)(FsmTelemetrySlot&, StateId) = nullptr;
+            void (*count_update)(FsmTelemetrySlot&) = nullptr;
+            void (*detach)(FsmTelemetrySlot&) = nullptr;
+        };
+
+        /* State of the opt-in features, allocated on the first use of one of them */
+        struct Extensions
+        {
+            std::unordered_map<StateId, std::vector<StateId>> declared_transitions;
+            std::unordered_map<StateId, std::vector<GuardedTransition>> guarded_transitions;
+
+            bool transition_stats_enabled = false;
+            std::unordered_map<std::pair<StateId, StateId>, std::unique_ptr<TransitionStats>> transitions_stats;
+            mutable std::mutex transitions_stats_mutex;
+
+            std::unordered_map<StateId, StateFactory> state_factories;
+            std::unordered_set<StateId> lazy_states_without_exit;                        // lazy states registered without *on exit* function
+            std::list<StateId> lazy_states_lru;                                         // built lazy states, most recently entered first
+            std::unordered_map<StateId, std::list<StateId>::iterator> lazy_states_positions;
+            std::size_t lazy_state_cache_capacity = 0;
+
+            std::vector<std::pair<StateId, std::unique_ptr<Fsm>>> regions;
+            bool regions_started = false;
+            std::function<std::future<bool>(std::function<bool()>)> submit_region_update;   // null to update the regions sequentially
+
+            FsmTelemetrySlot* telemetry_slot = nullptr;
+            TelemetryWriter telemetry_writer;
+            std::function<void()> telemetry_slot_released;
+        };
+        std::unique_ptr<Extensions> extensions;
+
+        Extensions& extension()
+        {
+            if (!extensions)
+                extensions = std::make_unique<Extensions>();
+            return *extensions;
+        }
+
+        /* Read-only view of the extension, empty if not allocated */
+        const Extensions& extension_view() const
+        {
+            static const Extensions empty;
+            return extensions ? *extensions : empty;
+        }
 
 
         /* Internal state id to identify undefined state or exit state of the FSM*/
@@ -0,0 +1,293 @@
+#pragma once
+
+#include <utils/Fsm/Fsm.h>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__AVX2__)
+    #include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#endif
+
+/* Implementation Details
+
+    The batch evaluation replaces the per-instance branching of the *on do* functions by a data-parallel evaluation of the transition guards.
+    The instance data used by the guards are laid out as a structure of arrays (one column per field, one row per instance) so that a guard
+    compares a whole column against a threshold with SIMD instructions (AVX2, SSE2 or a scalar fallback, selected at compile time).
+    The result is a bitmask of the instances taking the transition, then the transitions are applied in bulk.
+
+    The cost of a transition is dominated by the lookup of the transition override and of the state handler in the tables of the instance.
+    A step reads the state of each instance once into a state column, selects the candidates of each transition on that column, and groups
+    the transitions by source and destination states. The override and the handler of a group are resolved once per instance with
+    Fsm::prepare_transition(), kept from one step to the next, and only resolved again when the tables of the instance changed.
+
+    The batch guards are unrelated to the guards of Fsm::declare_transition(): a BatchGuard is evaluated by the batch over a column of
+    instance data, while a guarded transition declared on an Fsm is a std::function evaluated by that Fsm on its own update().
+    A batch step never evaluates the guards declared on the instances.
+
+*/
+
+namespace app::utils
+{
+
+    /** Guard predicate evaluated over a column of a structure-of-arrays batch: `column[i] <comparison> threshold`.
+     * 
+     *  It is independent of the guards declared with Fsm::declare_transition(), which the batch does not evaluate.
+     */
+    struct BatchGuard
+    {
+        enum struct Comparison
+        {
+            Less,
+            LessEqual,
+            Greater,
+            GreaterEqual
+        };
+
+        const float* column = nullptr;
+        Comparison comparison = Comparison::Greater;
+        float threshold = 0.0f;
+    };
+
+    /** Transition from a state to another state, taken by the instances of a batch for which the guard is true. */
+    struct BatchTransition
+    {
+        StateId from_state_id;
+        StateId to_state_id;
+        BatchGuard guard;
+
+        template <typename StateIdT1, typename StateIdT2>
+        BatchTransition(StateIdT1 from_state_id, StateIdT2 to_state_id, BatchGuard guard)
+            : from_state_id(StateId(from_state_id)), to_state_id(StateId(to_state_id)), guard(guard) {}
+    };
+
+    /** This component evaluates transition guards over a batch of FSM instances and applies the resulting transitions in bulk.
+     * 
+     *  The row *i* of the guard columns holds the data of the instance *i* of the batch.
+     */
+    class FsmBatch
+    {
+    public:
+
+        /** Number of 64-bit words of a mask covering a batch of the provided size. */
+        static constexpr std::size_t mask_size(std::size_t count) { return (count + 63) / 64; }
+
+        /** Evaluate a guard over the first rows of a batch.
+         * 
+         * @param guard The guard to evaluate.
+         * @param count The number of rows to evaluate.
+         * @param mask The output bitmask, of mask_size(count) words: the bit *i* is set if the guard is true for the row *i*.
+         */
+        static void evaluate(const BatchGuard& guard, std::size_t count, std::uint64_t* mask)
+        {
+            switch (guard.comparison)
+            {
+                case BatchGuard::Comparison::Less:         evaluate_column<BatchGuard::Comparison::Less>(guard, count, mask); break;
+                case BatchGuard::Comparison::LessEqual:    evaluate_column<BatchGuard::Comparison::LessEqual>(guard, count, mask); break;
+                case BatchGuard::Comparison::Greater:      evaluate_column<BatchGuard::Comparison::Greater>(guard, count, mask); break;
+                case BatchGuard::Comparison::GreaterEqual: evaluate_column<BatchGuard::Comparison::GreaterEqual>(guard, count, mask); break;
+            }
+        }
+
+        /** Apply a transition to the instances selected by a mask that are in the source state of the transition.
+         * 
+         * The transition is initiated with Fsm::transition_to, so the transition overrides apply.
+         * 
+         * @param instances The instances of the batch.
+         * @param mask The bitmask selecting the instances, of mask_size(instances.size()) words.
+         * @param from_state_id The state identifier of the source state.
+         * @param to_state_id The state identifier of the destination state.
+         * @return The number of transitions applied.
+         */
+        static std::size_t apply(std::span<Fsm* const> instances, const std::uint64_t* mask, StateId from_state_id, StateId to_state_id)
+        {
+            std::size_t applied = 0;
+
+            for (std::size_t word = 0; word < mask_size(instances.size()); ++word)
+            {
+                for (std::uint64_t bits = mask[word]; bits; bits &= bits - 1)
+                {
+                    auto& fsm = *instances[word * 64 + static_cast<std::size_t>(std::countr_zero(bits))];
+                    if (fsm.current_state_id() == from_state_id)
+                    {
+                        fsm.transition_to(to_state_id);
+                        ++applied;
+                    }
+                }
+            }
+
+            return applied;
+        }
+
+        /** Evaluate the guards of a set of transitions over a batch and apply the transitions.
+         * 
+         * The guards are all evaluated before any transition is applied, so an instance takes at most one transition per step:
+         * the first transition in the provided order whose source state is the state of the instance before the step and whose guard is true.
+         * The transitions sharing their source and destination states are applied as one group, with the override and the handler
+         * resolved by a previous step when the tables of the instance did not change since.
+         * 
+         * @param instances The instances of the batch.
+         * @param transitions The transitions, with guards over columns of at least instances.size() rows.
+         * @return The number of transitions applied.
+         */
+        std::size_t step(std::span<Fsm* const> instances, std::span<const BatchTransition> transitions)
+        {
+            const auto words = mask_size(instances.size());
+            masks.resize(words * transitions.size());
+            taken.assign(words, 0);
+
+            states.resize(instances.size());
+            for (std::size_t i = 0; i < instances.size(); ++i)
+                states[i] = instances[i]->current_state_id();
+
+            for (std::size_t t = 0; t < transitions.size(); ++t)
+            {
+                evaluate(transitions[t].guard, instances.size(), &masks[t * words]);
+                select_in_state(&masks[t * words], transitions[t].from_state_id);
+            }
+
+            // Merge the masks of the transitions of a group, keeping the first transition taken by each instance
+            groups.clear();
+            for (std::size_t t = 0; t < transitions.size(); ++t)
+            {
+                auto& group = find_or_add_group(transitions[t].from_state_id, transitions[t].to_state_id, words);
+                auto* mask = &masks[t * words];
+                for (std::size_t word = 0; word < words; ++word)
+                {
+                    group.mask[word] |= mask[word] & ~taken[word];
+                    taken[word] |= mask[word];
+                }
+            }
+
+            std::size_t applied = 0;
+            for (auto& group : groups)
+                applied += apply_group(instances, group);
+
+            return applied;
+        }
+
+    private:
+
+        /* Transitions of a step sharing their source and destination states */
+        struct Group
+        {
+            StateId from_state_id;
+            StateId to_state_id;
+            std::vector<std::uint64_t> mask;
+            std::vector<Fsm::PreparedTransition>* prepared;    // one per instance, kept across steps
+        };
+
+        std::vector<std::uint64_t> masks;
+        std::vector<std::uint64_t> taken;
+        std::vector<StateId> states;                           // state of each instance at the beginning of the step
+        std::vector<Group> groups;
+        std::unordered_map<std::pair<StateId, StateId>, std::vector<Fsm::PreparedTransition>> prepared_transitions;
+
+        Group& find_or_add_group(StateId from_state_id, StateId to_state_id, std::size_t words)
+        {
+            for (auto& group : groups)
+            {
+                if (group.from_state_id == from_state_id && group.to_state_id == to_state_id)
+                    return group;
+            }
+
+            auto& prepared = prepared_transitions[std::make_pair(from_state_id, to_state_id)];
+            if (prepared.size() < states.size())
+            {
+                Fsm::PreparedTransition unresolved;
+                unresolved.from_state_id = from_state_id;
+                unresolved.requested_state_id = to_state_id;
+                prepared.resize(states.size(), unresolved);
+            }
+
+            return groups.emplace_back(Group{from_state_id, to_state_id, std::vector<std::uint64_t>(words, 0), &prepared});
+        }
+
+        /* Take the transition of a group for the selected instances, resolving it only for the instances whose tables changed */
+        static std::size_t apply_group(std::span<Fsm* const> instances, Group& group)
+        {
+            std::size_t applied = 0;
+
+            for (std::size_t word = 0; word < group.mask.size(); ++word)
+            {
+                for (std::uint64_t bits = group.mask[word]; bits; bits &= bits - 1)
+                {
+                    auto i = word * 64 + static_cast<std::size_t>(std::countr_zero(bits));
+                    if (instances[i]->take_prepared_transition((*group.prepared)[i]))
+                        ++applied;
+                }
+            }
+
+            return applied;
+        }
+
+        /* Keep only the selected instances that were in the provided state at the beginning of the step */
+        void select_in_state(std::uint64_t* mask, StateId state_id) const
+        {
+            for (std::size_t word = 0; word < mask_size(states.size()); ++word)
+            {
+                for (std::uint64_t bits = mask[word]; bits; bits &= bits - 1)
+                {
+                    auto bit = static_cast<std::size_t>(std::countr_zero(bits));
+                    if (!(states[word * 64 + bit] == state_id))
+                        mask[word] &= ~(std::uint64_t{1} << bit);
+                }
+            }
+        }
+
+        template <BatchGuard::Comparison C>
+        static bool compare(float value, float threshold)
+        {
+            if constexpr (C == BatchGuard::Comparison::Less)           return value < threshold;
+            else if constexpr (C == BatchGuard::Comparison::LessEqual) return value <= threshold;
+            else if constexpr (C == BatchGuard::Comparison::Greater)   return value > threshold;
+            else                                                       return value >= threshold;
+        }
+
+        template <BatchGuard::Comparison C>
+        static void evaluate_column(const BatchGuard& guard, std::size_t count, std::uint64_t* mask)
+        {
+            std::size_t i = 0;
+
+            for (std::size_t word = 0; word < mask_size(count); ++word)
+                mask[word] = 0;
+
+#if defined(__AVX2__)
+            constexpr int predicate = C == BatchGuard::Comparison::Less      ? _CMP_LT_OQ
+                                    : C == BatchGuard::Comparison::LessEqual ? _CMP_LE_OQ
+                                    : C == BatchGuard::Comparison::Greater   ? _CMP_GT_OQ
+                                                                             : _CMP_GE_OQ;
+            const __m256 threshold = _mm256_set1_ps(guard.threshold);
+            for (const std::size_t end = count - count % 8; i < end; i += 8)
+            {
+                auto bits = static_cast<std::uint64_t>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(guard.column + i), threshold, predicate)));
+                mask[i / 64] |= bits << (i % 64);
+            }
+#elif defined(__SSE2__) || defined(_M_X64)
+            const __m128 threshold = _mm_set1_ps(guard.threshold);
+            for (const std::size_t end = count - count % 4; i < end; i += 4)
+            {
+                const __m128 values = _mm_loadu_ps(guard.column + i);
+                __m128 result;
+                if constexpr (C == BatchGuard::Comparison::Less)           result = _mm_cmplt_ps(values, threshold);
+                else if constexpr (C == BatchGuard::Comparison::LessEqual) result = _mm_cmple_ps(values, threshold);
+                else if constexpr (C == BatchGuard::Comparison::Greater)   result = _mm_cmpgt_ps(values, threshold);
+                else                                                       result = _mm_cmpge_ps(values, threshold);
+                mask[i / 64] |= static_cast<std::uint64_t>(_mm_movemask_ps(result)) << (i % 64);
+            }
+#endif
+            for (; i < count; ++i)
+            {
+                if (compare<C>(guard.column[i], guard.threshold))
+                    mask[i / 64] |= std::uint64_t{1} << (i % 64);
+            }
+        }
+    };
+}
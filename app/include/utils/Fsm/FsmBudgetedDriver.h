@@ -0,0 +1,261 @@
+#pragma once
+
+#include <utils/Fsm/Fsm.h>
+#include <utils/Tsc/Tsc.h>
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+/* Implementation Details
+
+    The driver updates a fleet of FSM instances in successive ticks, each tick being bounded by a budget: a maximum duration and/or a
+    maximum number of updates. When the budget is exhausted, the tick ends and the next one resumes where it stopped, so that a burst of
+    expensive updates is spread over several ticks instead of stalling the process.
+
+    The instances are picked in this order:
+
+    - the starving instance: the next instance of the round-robin, if it has not been updated for more than the starvation limit (in ticks),
+    - the overdue instances: the instances woken with wake(), in wake order,
+    - the round-robin: the next instance after the cursor, i.e. the least recently updated one.
+
+    An instance woken after its update in the current tick keeps its wake: it is deferred to the next tick, in which it comes first.
+
+    The elapsed time is measured with the time stamp counter (Tsc), read once per update instead of calling std::chrono::steady_clock.
+    The Tsc is calibrated by the constructor of the driver, as its calibration sleeps a few milliseconds: in the first tick, it would
+    exhaust the budget. At least one instance is updated per tick, so that the fleet always progresses.
+
+    A tick ends when all the instances have been updated, counting down the instances still pending. An update may remove another
+    instance: a pending removed instance is taken off the count, so that the tick still ends. The pending wake of a removed instance is
+    dropped with it: the instance added again starts without wake.
+
+*/
+
+namespace app::utils
+{
+
+    /** This component updates a fleet of FSM instances in time- or work-budgeted ticks, resuming each tick where the previous one stopped. */
+    class FsmBudgetedDriver
+    {
+    public:
+
+        /** Budget of a tick. The tick ends as soon as one of the limits is reached. */
+        struct Budget
+        {
+            std::chrono::nanoseconds max_duration = std::chrono::nanoseconds::max();
+            std::size_t max_updates = std::numeric_limits<std::size_t>::max();
+        };
+
+        /** Driver statistics */
+        struct Stats
+        {
+            std::uint64_t ticks = 0;                ///< number of ticks
+            std::uint64_t updates = 0;              ///< number of updates
+            std::uint64_t exhausted_ticks = 0;      ///< number of ticks ended by the budget before a full pass
+            std::uint64_t starving_updates = 0;     ///< number of updates given in priority to a starving instance
+            std::uint64_t overdue_updates = 0;      ///< number of updates given in priority to a woken instance
+        };
+
+        /** Create an empty driver, calibrating the time stamp counter (see Tsc::ticks_per_ns()) so that the first tick does not pay for it. */
+        FsmBudgetedDriver()
+        {
+            Tsc::ticks_per_ns();
+        }
+
+        /** Add an instance to the fleet.
+         *
+         * @param fsm The instance, started. It must outlive its registration.
+         */
+        void add(Fsm& fsm)
+        {
+            if (indexes.find(&fsm) != indexes.end())
+                return;
+
+            indexes[&fsm] = entries.size();
+            entries.push_back({&fsm, stats.ticks, false});
+        }
+
+        /** Remove an instance from the fleet. */
+        void remove(Fsm& fsm)
+        {
+            auto it = indexes.find(&fsm);
+            if (it == indexes.end())
+                return;
+
+            auto index = it->second;
+            indexes.erase(it);
+
+            // Removed before its update by the current tick (e.g. by the update of another instance)
+            if (entries[index].last_tick != stats.ticks && pending_updates > 0)
+                --pending_updates;
+
+            // Its pending wake is dropped, so that it does not give an overdue update to a later registration of the same instance
+            if (entries[index].woken)
+            {
+                std::erase(woken, &fsm);
+                std::erase(deferred_wakes, &fsm);
+            }
+
+            // The last entry takes the place of the removed one. It is not skipped by the round-robin: it is reached before the
+            // wrap of the cursor if it lands ahead of the cursor, and right after the wrap otherwise
+            if (index != entries.size() - 1)
+            {
+                entries[index] = entries.back();
+                indexes[entries[index].fsm] = index;
+            }
+            entries.pop_back();
+
+            if (cursor >= entries.size())
+                cursor = 0;
+        }
+
+        /** Mark an instance as overdue: it is updated in priority on the next tick.
+         *
+         * @param fsm The instance, previously added.
+         */
+        void wake(Fsm& fsm)
+        {
+            auto it = indexes.find(&fsm);
+            if (it == indexes.end() || entries[it->second].woken)
+                return;
+
+            entries[it->second].woken = true;
+            woken.push_back(&fsm);
+        }
+
+        /** Update the instances of the fleet within a budget.
+         *
+         * A tick updates each instance at most once. The instances whose update returns false (exited) are removed from the fleet.
+         *
+         * @param budget The budget of the tick.
+         * @return The number of updated instances.
+         */
+        std::size_t tick(const Budget& budget)
+        {
+            ++stats.ticks;
+
+            const auto deadline = budget.max_duration == std::chrono::nanoseconds::max()
+                ? std::numeric_limits<std::uint64_t>::max()
+                : Tsc::now() + Tsc::to_ticks(budget.max_duration);
+
+            std::size_t updated = 0;
+            pending_updates = entries.size();
+
+            while (pending_updates > 0 && updated < budget.max_updates)
+            {
+                Priority priority;
+                Entry* entry = next_entry(priority);
+                if (!entry)
+                    break;
+
+                if (entry->last_tick == stats.ticks)
+                {
+                    // Already updated by this tick, before the cursor wrapped
+                    continue;
+                }
+
+                entry->last_tick = stats.ticks;
+                --pending_updates;
+                ++updated;
+                ++stats.updates;
+                if (priority == Priority::Starving)
+                    ++stats.starving_updates;
+                else if (priority == Priority::Overdue)
+                    ++stats.overdue_updates;
+
+                auto* fsm = entry->fsm;
+                if (!fsm->update())
+                    remove(*fsm);
+
+                if (Tsc::now() >= deadline)
+                    break;
+            }
+
+            if (pending_updates > 0)
+                ++stats.exhausted_ticks;
+            pending_updates = 0;
+
+            // The wakes deferred by this tick come first in the next one, in wake order
+            woken.insert(woken.begin(), deferred_wakes.begin(), deferred_wakes.end());
+            deferred_wakes.clear();
+
+            return updated;
+        }
+
+        /** Set the number of ticks without update after which an instance is starving (8 by default). */
+        void set_starvation_limit(std::uint64_t ticks) { starvation_limit = ticks; }
+
+        /** Get the driver statistics. */
+        const Stats& get_stats() const { return stats; }
+
+        /** Get the number of instances of the fleet. */
+        std::size_t size() const { return entries.size(); }
+
+    private:
+
+        struct Entry
+        {
+            Fsm* fsm;
+            std::uint64_t last_tick;
+            bool woken;
+        };
+
+        std::vector<Entry> entries;
+        std::unordered_map<Fsm*, std::size_t> indexes;
+        std::deque<Fsm*> woken;
+        std::vector<Fsm*> deferred_wakes;               // woken after their update in the current tick
+        std::size_t cursor = 0;
+        std::size_t pending_updates = 0;                // instances not updated yet by the current tick
+        std::uint64_t starvation_limit = 8;
+        Stats stats;
+
+        enum struct Priority
+        {
+            Starving,
+            Overdue,
+            RoundRobin
+        };
+
+        /* Pick the next instance to update: the starving round-robin instance, then the woken instances, then the round-robin */
+        Entry* next_entry(Priority& priority)
+        {
+            if (entries.empty())
+                return nullptr;
+
+            // Starving: more than starvation_limit ticks without update, between its last update and the current tick
+            auto& round_robin = entries[cursor];
+            bool starving = stats.ticks > round_robin.last_tick + starvation_limit + 1;
+
+            if (!starving)
+            {
+                while (!woken.empty())
+                {
+                    auto* fsm = woken.front();
+                    woken.pop_front();
+
+                    auto it = indexes.find(fsm);
+                    if (it == indexes.end())
+                        continue;
+
+                    auto& entry = entries[it->second];
+                    if (entry.last_tick == stats.ticks)
+                    {
+                        deferred_wakes.push_back(fsm);
+                        continue;
+                    }
+
+                    entry.woken = false;
+                    priority = Priority::Overdue;
+                    return &entry;
+                }
+            }
+
+            priority = starving ? Priority::Starving : Priority::RoundRobin;
+            cursor = (cursor + 1) % entries.size();
+            return &round_robin;
+        }
+    };
+}
@@ -0,0 +1,247 @@
+#pragma once
+
+#include <utils/Fsm/Fsm.h>
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+/* Implementation Details
+
+    The registry is a generational slot map. The instances are stored in slots, allocated by chunks that never move (Fsm is neither
+    copyable nor movable), and are created in place in their slot. A handle is a 64-bit value made of the index of the slot (low 32 bits)
+    and of the generation of the slot (high 32 bits). The generation of a slot is incremented when its instance is destroyed, so that the
+    handles of the destroyed instance become stale: a lookup with a stale handle fails instead of returning the instance that reuses the slot.
+
+    - create: pop a slot from the free list (or take a new one) and construct the instance in place, O(1),
+    - destroy: destroy the instance in place, increment the generation and push the slot to the free list, O(1),
+    - lookup: index the slot and compare the generations, O(1), without hashing.
+
+    The indexes of the live slots are kept in a dense array (swap-remove on destroy), so an update pass iterates over the live instances only.
+    Once the chunks are allocated, creating and destroying instances does not allocate memory.
+
+*/
+
+namespace app::utils
+{
+
+    /** This component stores FSM instances in a generational slot map, identified by stable 64-bit handles. */
+    class FsmRegistry
+    {
+    public:
+
+        /** Handle of an instance. It becomes stale when the instance is destroyed. The default handle is always stale. */
+        struct Handle
+        {
+            std::uint64_t value = 0;
+
+            bool operator==(const Handle& other) const { return value == other.value; }
+            bool operator!=(const Handle& other) const { return value != other.value; }
+        };
+
+        /** Number of slots allocated at once */
+        static constexpr std::size_t chunk_size = 1024;
+
+        FsmRegistry() = default;
+        FsmRegistry(const FsmRegistry&) = delete;
+        FsmRegistry& operator=(const FsmRegistry&) = delete;
+
+        /** Create an instance.
+         *
+         * @return The handle of the new instance.
+         * @throw std::runtime_error if the registry is full (2^32 - 1 slots).
+         */
+        Handle create()
+        {
+            std::uint32_t index;
+            if (free_head != no_slot)
+            {
+                index = free_head;
+                free_head = slot(index).next_free;
+            }
+            else
+            {
+                if (slots_count == no_slot)
+                    throw std::runtime_error("The FSM registry is full");
+                if (slots_count == chunks.size() * chunk_size)
+                    chunks.push_back(std::make_unique<Slot[]>(chunk_size));
+                index = slots_count++;
+            }
+
+            auto& created = slot(index);
+            created.fsm.emplace();
+            created.pass = update_pass;
+            created.visit = visit_pass;
+            created.dense_index = static_cast<std::uint32_t>(dense.size());
+            dense.push_back(index);
+
+            return make_handle(index, created.generation);
+        }
+
+        /** Destroy an instance. Its handles become stale.
+         *
+         * @param handle The handle of the instance.
+         * @return True if the instance has been destroyed, false if the handle is stale.
+         */
+        bool destroy(Handle handle)
+        {
+            auto* destroyed = find_slot(handle);
+            if (!destroyed)
+                return false;
+
+            auto index = index_of(handle);
+
+            // Swap-remove the slot from the dense array
+            auto last = dense.back();
+            dense[destroyed->dense_index] = last;
+            slot(last).dense_index = destroyed->dense_index;
+            dense.pop_back();
+
+            destroyed->fsm.reset();
+            // Skip the generation 0, so that the default handle is always stale
+            if (++destroyed->generation == 0)
+                destroyed->generation = 1;
+            destroyed->next_free = free_head;
+            free_head = index;
+
+            return true;
+        }
+
+        /** Get an instance.
+         *
+         * @param handle The handle of the instance.
+         * @return A pointer to the instance, or nullptr if the handle is stale.
+         */
+        Fsm* find(Handle handle)
+        {
+            auto* found = find_slot(handle);
+            return found ? &*found->fsm : nullptr;
+        }
+
+        /** Get an instance.
+         *
+         * @param handle The handle of the instance.
+         * @return The instance.
+         * @throw std::runtime_error if the handle is stale.
+         */
+        Fsm& at(Handle handle)
+        {
+            auto* found = find(handle);
+            if (!found)
+                throw std::runtime_error("Stale FSM handle");
+            return *found;
+        }
+
+        /** Check if a handle refers to a live instance. */
+        bool contains(Handle handle) const { return find_slot(handle) != nullptr; }
+
+        /** Call a function on each live instance, in the order of the dense array.
+         *
+         * The function may destroy instances and create new instances. Each instance live at the start of the pass is visited at most once
+         * (an instance destroyed before its visit is not visited), the instances created by the pass are not visited.
+         *
+         * @param function The function, called with the handle and the instance.
+         */
+        template <typename Function>
+        void for_each(Function&& function)
+        {
+            ++visit_pass;
+            // Backward, as in update_all(): a swap-remove may move an instance already visited (or created by the pass) to a lower index,
+            // so the visited instances are marked with the pass.
+            for (auto i = dense.size(); i-- > 0;)
+            {
+                if (i >= dense.size())
+                    continue;
+                auto index = dense[i];
+                auto& visited = slot(index);
+                if (visited.visit == visit_pass)
+                    continue;
+                visited.visit = visit_pass;
+                function(make_handle(index, visited.generation), *visited.fsm);
+            }
+        }
+
+        /** Update all the live instances.
+         *
+         * An update may destroy instances and create new instances. Each instance live at the start of the pass is updated at most once, the
+         * instances created by the pass are not updated.
+         *
+         * @return The number of instances whose update returned false (exited). They are not destroyed.
+         */
+        std::size_t update_all()
+        {
+            std::size_t exited = 0;
+            ++update_pass;
+            // Backward by index, as in for_each(): an update may swap-remove or append to the dense array. A swap-remove may move an
+            // instance already updated to a lower index, so the updated instances are marked with the pass.
+            for (auto i = dense.size(); i-- > 0;)
+            {
+                if (i >= dense.size())
+                    continue;
+                auto& updated = slot(dense[i]);
+                if (!updated.fsm || updated.pass == update_pass)
+                    continue;
+                updated.pass = update_pass;
+                if (!updated.fsm->update())
+                    ++exited;
+            }
+            return exited;
+        }
+
+        /** Get the number of live instances. */
+        std::size_t size() const { return dense.size(); }
+
+        /** Get the number of allocated slots. */
+        std::size_t capacity() const { return chunks.size() * chunk_size; }
+
+    private:
+
+        static constexpr std::uint32_t no_slot = std::numeric_limits<std::uint32_t>::max();
+
+        struct Slot
+        {
+            std::optional<Fsm> fsm;
+            std::uint32_t generation = 1;
+            std::uint32_t dense_index = 0;          // position in the dense array, while live
+            std::uint32_t next_free = no_slot;      // next slot of the free list, while free
+            std::uint32_t pass = 0;                 // last update_all() pass that updated (or created) the instance
+            std::uint32_t visit = 0;                // last for_each() pass that visited (or created) the instance
+        };
+
+        std::vector<std::unique_ptr<Slot[]>> chunks;
+        std::vector<std::uint32_t> dense;
+        std::uint32_t slots_count = 0;
+        std::uint32_t free_head = no_slot;
+        std::uint32_t update_pass = 0;
+        std::uint32_t visit_pass = 0;
+
+        static Handle make_handle(std::uint32_t index, std::uint32_t generation)
+        {
+            return Handle{(static_cast<std::uint64_t>(generation) << 32) | index};
+        }
+
+        static std::uint32_t index_of(Handle handle) { return static_cast<std::uint32_t>(handle.value); }
+        static std::uint32_t generation_of(Handle handle) { return static_cast<std::uint32_t>(handle.value >> 32); }
+
+        Slot& slot(std::uint32_t index) { return chunks[index / chunk_size][index % chunk_size]; }
+        const Slot& slot(std::uint32_t index) const { return chunks[index / chunk_size][index % chunk_size]; }
+
+        const Slot* find_slot(Handle handle) const
+        {
+            auto index = index_of(handle);
+            if (index >= slots_count)
+                return nullptr;
+
+            const auto& found = slot(index);
+            return found.fsm.has_value() && found.generation == generation_of(handle) ? &found : nullptr;
+        }
+
+        Slot* find_slot(Handle handle)
+        {
+            return const_cast<Slot*>(static_cast<const FsmRegistry*>(this)->find_slot(handle));
+        }
+    };
+}
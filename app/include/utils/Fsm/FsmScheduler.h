@@ -0,0 +1,275 @@
+#pragma once
+
+#include <utils/Fsm/Fsm.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <utility>
+#include <unordered_map>
+#include <vector>
+
+/* Implementation Details
+
+    The scheduler keeps the FSM instances in a min-heap ordered by their next deadline (Earliest Deadline First). A scheduling pass pops
+    the instances whose deadline is reached, updates them, and pushes them back with their next deadline, computed from the update period
+    of their current state (declared with Fsm::UpdatePeriod at registration). The cost of a pass therefore depends on the number of due
+    instances, not on the size of the fleet.
+
+    An instance is late when it is updated after its deadline plus a tolerance: this is reported as a deadline miss. By default, the tolerance
+    is zero, so that a late update of a sub-millisecond state is reported as well as the one of a 1 s state: with a real clock, the caller
+    sets a tolerance covering its wake up jitter. Tolerating a whole update period of each instance (only the skipped periods are misses) is
+    an opt-in. A deadline is the time given to add(), or the one computed from an update period: an instance added without time, or without
+    update period, is due at once (at the next pass), which is not a deadline to miss. A late instance is rescheduled from the current time,
+    skipping its missed periods instead of bursting to catch up.
+
+    An instance without update period is due again at once, i.e. updated once per pass. A minimum update period can be set instead (e.g. the
+    time step of a simulation): the instances with a shorter period are then rescheduled after it, as if it were their period, so that they
+    are not reported late while waiting for the next step.
+
+    If an update (or the deadline miss handler) throws, the instances already updated by the pass are pushed back before the exception is
+    propagated, and the failing instance is rescheduled as if its update succeeded, or removed if it exited.
+
+    The removal of an instance is lazy: its heap entries are discarded when popped. An update may remove instances (including its own) or
+    add ones, which may rehash the generations map: the updated instance is looked up again after its update, and only rescheduled (or
+    removed) if it is still scheduled with the generation of its entry.
+
+*/
+
+namespace app::utils
+{
+
+    /** This component schedules the updates of a fleet of FSM instances, calling Fsm::update() only when an instance is due.
+     *
+     * @tparam Clock The clock providing the current time (std::chrono clock interface), e.g. a virtual clock for simulations.
+     */
+    template <typename Clock = std::chrono::steady_clock>
+    class FsmScheduler
+    {
+    public:
+
+        using clock = Clock;
+        using time_point = typename Clock::time_point;
+        using duration = typename Clock::duration;
+
+        /** Scheduling statistics */
+        struct Stats
+        {
+            std::uint64_t updates = 0;              ///< number of updates
+            std::uint64_t deadline_misses = 0;      ///< number of updates later than their deadline plus the tolerance (see set_miss_tolerance())
+            duration max_lateness{0};               ///< maximum delay between a deadline and the update (the instances due at once have no deadline)
+        };
+
+        /** Handler called on a deadline miss, with the late instance and its lateness */
+        using DeadlineMissHandler = std::function<void(Fsm& fsm, duration lateness)>;
+
+        /** Tag of set_miss_tolerance(), to tolerate the update period each instance was scheduled with */
+        struct PeriodTolerance {};
+
+        /** Add an instance to the scheduler. It is due at once, on the next pass, without deadline to miss.
+         *
+         * @param fsm The instance to schedule, started. It must outlive its scheduling.
+         */
+        void add(Fsm& fsm) { add_entry(fsm, Clock::now(), false); }
+
+        /** Add an instance to the scheduler, due at the provided time.
+         *
+         * @param fsm The instance to schedule, started. It must outlive its scheduling.
+         * @param deadline The time of its first update, reported as missed if the update is later than it plus the tolerance.
+         */
+        void add(Fsm& fsm, time_point deadline) { add_entry(fsm, deadline, true); }
+
+        /** Remove an instance from the scheduler. It is not updated anymore.
+         *
+         * @param fsm The instance to remove.
+         */
+        void remove(Fsm& fsm) { generations.erase(&fsm); }
+
+        /** Update the instances whose deadline is reached.
+         *
+         * Each due instance is updated once, in deadline order, then rescheduled one update period of its current state after its deadline
+         * (or after the provided time if it was late). An instance whose update returns false (exited) is removed from the scheduler.
+         *
+         * If an update or the deadline miss handler throws, the exception is propagated once the instances updated by the pass are
+         * rescheduled. The failing instance is rescheduled as if its update succeeded, or removed if it exited.
+         *
+         * @param now The current time.
+         * @return The number of updated instances.
+         */
+        std::size_t run_due(time_point now)
+        {
+            std::size_t updated = 0;
+            rescheduled.clear();
+
+            while (!queue.empty() && queue.top().deadline <= now)
+            {
+                auto entry = queue.top();
+                queue.pop();
+
+                if (!is_scheduled(entry))
+                    continue;
+
+                bool running = true;
+                try
+                {
+                    auto lateness = now - entry.deadline;
+                    if (entry.has_deadline && lateness > stats.max_lateness)
+                        stats.max_lateness = lateness;
+                    if (is_deadline_miss(entry, lateness))
+                    {
+                        ++stats.deadline_misses;
+                        if (deadline_miss_handler)
+                            deadline_miss_handler(*entry.fsm, lateness);
+                    }
+
+                    ++stats.updates;
+                    ++updated;
+
+                    running = entry.fsm->update();
+                }
+                catch (...)
+                {
+                    if (is_scheduled(entry))
+                    {
+                        if (entry.fsm->is_exit())
+                            generations.erase(entry.fsm);
+                        else
+                            reschedule(entry, now);
+                    }
+                    push_rescheduled();
+                    throw;
+                }
+
+                // Removed (or removed and added again) by its own update
+                if (!is_scheduled(entry))
+                    continue;
+
+                if (running)
+                    reschedule(entry, now);
+                else
+                    generations.erase(entry.fsm);
+            }
+
+            push_rescheduled();
+            return updated;
+        }
+
+        /** Update the instances whose deadline is reached, at the current time of the clock. */
+        std::size_t run_due() { return run_due(Clock::now()); }
+
+        /** Get the earliest deadline of the scheduled instances.
+         *
+         * It allows the caller to sleep (or to wait for I/O) until the next due instance.
+         *
+         * @return The earliest deadline, or an empty optional if no instance is scheduled.
+         */
+        std::optional<time_point> next_deadline()
+        {
+            while (!queue.empty())
+            {
+                const auto& entry = queue.top();
+                if (is_scheduled(entry))
+                    return entry.deadline;
+                queue.pop();
+            }
+            return std::nullopt;
+        }
+
+        /** Set the lateness tolerated before an update is reported as a deadline miss.
+         *
+         * By default, the tolerance is zero: any late update is a miss. With a real clock, the tolerance covers the wake up jitter of the caller.
+         *
+         * @param tolerance The lateness tolerated for all the instances.
+         */
+        void set_miss_tolerance(duration tolerance) { miss_tolerance = tolerance; }
+
+        /** Tolerate the update period each instance was scheduled with: its update is a miss only when a whole period was skipped.
+         *
+         * An instance whose update period is null (without minimum update period) then never misses its deadline.
+         */
+        void set_miss_tolerance(PeriodTolerance) { miss_tolerance.reset(); }
+
+        /** Set the minimum update period: the instances whose current state has a shorter (e.g. null) update period are rescheduled after it.
+         *
+         * By default (zero), an instance without update period is updated once per pass. The minimum applies from the next reschedule.
+         *
+         * @param period The minimum delay between two updates of an instance.
+         */
+        void set_min_update_period(duration period) { min_update_period = period; }
+
+        /** Set the handler called on each deadline miss. */
+        void on_deadline_miss(DeadlineMissHandler handler) { deadline_miss_handler = std::move(handler); }
+
+        /** Get the scheduling statistics. */
+        const Stats& get_stats() const { return stats; }
+
+        /** Get the number of scheduled instances. */
+        std::size_t size() const { return generations.size(); }
+
+    private:
+
+        struct Entry
+        {
+            time_point deadline;
+            duration period;                    // update period the instance was scheduled with
+            Fsm* fsm;
+            std::uint64_t generation;
+            bool has_deadline;                  // false if due at once (added without time, or without update period)
+
+            bool operator>(const Entry& other) const { return deadline > other.deadline; }
+        };
+
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+        std::vector<Entry> rescheduled;
+        std::unordered_map<Fsm*, std::uint64_t> generations;
+        std::uint64_t last_generation = 0;
+
+        std::optional<duration> miss_tolerance{duration::zero()};     // empty to tolerate the period of each instance
+        duration min_update_period{0};
+        DeadlineMissHandler deadline_miss_handler;
+        Stats stats;
+
+        void add_entry(Fsm& fsm, time_point deadline, bool has_deadline)
+        {
+            auto generation = ++last_generation;
+            generations[&fsm] = generation;
+            queue.push({deadline, std::max(std::chrono::duration_cast<duration>(fsm.current_update_period()), min_update_period), &fsm, generation, has_deadline});
+        }
+
+        /* True if the instance of the entry is still scheduled with the generation of the entry */
+        bool is_scheduled(const Entry& entry) const
+        {
+            auto it = generations.find(entry.fsm);
+            return it != generations.end() && it->second == entry.generation;
+        }
+
+        bool is_deadline_miss(const Entry& entry, duration lateness) const
+        {
+            if (!entry.has_deadline)
+                return false;
+            if (miss_tolerance)
+                return lateness > *miss_tolerance;
+            return entry.period > duration::zero() && lateness > entry.period;
+        }
+
+        /* Schedule the next update of an instance one update period of its current state after its deadline, or after now if it was late */
+        void reschedule(Entry entry, time_point now)
+        {
+            entry.period = std::max(std::chrono::duration_cast<duration>(entry.fsm->current_update_period()), min_update_period);
+            entry.has_deadline = entry.period > duration::zero();
+            entry.deadline = entry.deadline + entry.period <= now ? now + entry.period : entry.deadline + entry.period;
+            rescheduled.push_back(entry);
+        }
+
+        /* Pushed back after the pass, so that an instance with a null period is updated once per pass */
+        void push_rescheduled()
+        {
+            for (const auto& entry : rescheduled)
+                queue.push(entry);
+            rescheduled.clear();
+        }
+    };
+}
@@ -0,0 +1,385 @@
+#pragma once
+
+#include <utils/Fsm/Fsm.h>
+#include <utils/Fsm/FsmScheduler.h>
+#include <utils/ThreadPool/ThreadPool.h>
+#include <utils/VirtualClock/VirtualClock.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <future>
+#include <queue>
+#include <random>
+#include <vector>
+
+/* Implementation Details
+
+    The simulator runs a fleet of FSM instances in virtual time (see VirtualClock), as fast as the CPU allows. It is a discrete event
+    simulation: the instances are updated by a FsmScheduler<VirtualClock>, at the update period of their current state, and the external
+    stimuli (e.g. the arrival of a request) are events scheduled at a virtual time. Each step moves the clock directly to the earliest
+    deadline or event, so the idle time between them costs nothing:
+
+    - the events due at the current time are called, in time then scheduling order. An event typically initiates a transition, and may
+      schedule other events,
+    - the instances due at the current time are updated. An event changing the update period of an instance wakes it (wake()), so that
+      it is rescheduled from its new state.
+
+    A state without update period would be due again at the same time: such instances are updated once per resolution step (1 ms by
+    default), so that the virtual time progresses. The resolution is the minimum update period of the scheduler: these instances are
+    rescheduled one step later, and are not reported late while waiting for it.
+
+    A simulation is deterministic: its random generator is seeded by its seed, and its clock is thread local. Independent seeds can
+    therefore run in parallel on a ThreadPool (run_seeds()), each seed building its own fleet on the worker thread running it, and their
+    statistics are merged in seed order.
+
+    The latencies recorded by the simulated code (e.g. from the arrival of a request to its response, in virtual time) are counted in a
+    log-linear histogram: 8 buckets per power of two, i.e. a relative error below 12.5%, in a constant memory whatever the number of samples.
+
+*/
+
+namespace app::utils
+{
+
+    /** This component runs a fleet of FSM instances in virtual time, skipping the idle time between the updates and the events. */
+    class FsmSimulator
+    {
+    public:
+
+        using clock = VirtualClock;
+        using time_point = VirtualClock::time_point;
+        using duration = VirtualClock::duration;
+
+        /** Histogram of latencies, with a relative error below 12.5% */
+        class LatencyHistogram
+        {
+        public:
+
+            /** Count a latency. Negative latencies are counted as 0. */
+            void record(duration latency)
+            {
+                auto value = static_cast<std::uint64_t>(std::max<duration::rep>(latency.count(), 0));
+                ++buckets[bucket_of(value)];
+                ++samples;
+                total += value;
+                maximum = std::max(maximum, value);
+            }
+
+            /** Add the latencies of another histogram. */
+            void merge(const LatencyHistogram& other)
+            {
+                for (std::size_t i = 0; i < buckets.size(); ++i)
+                    buckets[i] += other.buckets[i];
+                samples += other.samples;
+                total += other.total;
+                maximum = std::max(maximum, other.maximum);
+            }
+
+            /** Get a percentile of the latencies.
+             *
+             * @param percent The percentile, between 0 and 100.
+             * @return The upper bound of the bucket of the percentile (capped by the maximum latency), 0 if no latency was recorded.
+             */
+            duration percentile(double percent) const
+            {
+                if (samples == 0)
+                    return duration(0);
+
+                auto rank = static_cast<std::uint64_t>(percent / 100.0 * static_cast<double>(samples));
+                rank = std::clamp<std::uint64_t>(rank, 1, samples);
+
+                std::uint64_t count = 0;
+                for (std::size_t i = 0; i < buckets.size(); ++i)
+                {
+                    count += buckets[i];
+                    if (count >= rank)
+                        return duration(static_cast<duration::rep>(std::min(upper_bound_of(i), maximum)));
+                }
+                return max();
+            }
+
+            /** Get the number of recorded latencies. */
+            std::uint64_t count() const { return samples; }
+
+            /** Get the mean latency, 0 if no latency was recorded. */
+            duration mean() const { return duration(samples ? static_cast<duration::rep>(total / samples) : 0); }
+
+            /** Get the maximum latency. */
+            duration max() const { return duration(static_cast<duration::rep>(maximum)); }
+
+        private:
+
+            static constexpr std::size_t sub_buckets = 8;   // per power of two
+
+            static std::size_t bucket_of(std::uint64_t value)
+            {
+                if (value < sub_buckets)
+                    return static_cast<std::size_t>(value);
+
+                auto exponent = static_cast<std::size_t>(std::bit_width(value)) - 1;   // >= 3
+                auto sub_bucket = static_cast<std::size_t>(value >> (exponent - 3)) & (sub_buckets - 1);
+                return (exponent - 2) * sub_buckets + sub_bucket;
+            }
+
+            static std::uint64_t upper_bound_of(std::size_t bucket)
+            {
+                if (bucket < sub_buckets)
+                    return bucket;
+
+                auto exponent = bucket / sub_buckets + 2;
+                auto lower = (sub_buckets + bucket % sub_buckets) << (exponent - 3);
+                return lower + (std::uint64_t{1} << (exponent - 3)) - 1;
+            }
+
+            std::array<std::uint64_t, 62 * sub_buckets> buckets{};
+            std::uint64_t samples = 0;
+            std::uint64_t total = 0;
+            std::uint64_t maximum = 0;
+        };
+
+        /** Simulation statistics */
+        struct Stats
+        {
+            std::size_t seeds = 0;                      ///< number of merged simulations
+            std::uint64_t updates = 0;                  ///< number of updates
+            std::uint64_t transitions = 0;              ///< number of transitions of the simulated instances
+            std::uint64_t events = 0;                   ///< number of called events
+            std::uint64_t deadline_misses = 0;          ///< number of updates later than their deadline (see FsmScheduler)
+            duration max_lateness{0};                   ///< maximum delay between a deadline and the update, in virtual time
+            duration simulated_time{0};                 ///< simulated virtual time, summed over the seeds
+            std::chrono::nanoseconds wall_time{0};      ///< real time spent to simulate it
+            LatencyHistogram latencies;                 ///< latencies recorded by the simulated code
+
+            /** Add the statistics of another simulation. The wall times are summed, as if the simulations ran sequentially. */
+            void merge(const Stats& other)
+            {
+                seeds += other.seeds;
+                updates += other.updates;
+                transitions += other.transitions;
+                events += other.events;
+                deadline_misses += other.deadline_misses;
+                max_lateness = std::max(max_lateness, other.max_lateness);
+                simulated_time += other.simulated_time;
+                wall_time += other.wall_time;
+                latencies.merge(other.latencies);
+            }
+
+            /** Get the ratio between the simulated time and the wall time. */
+            double speedup() const
+            {
+                return wall_time.count() > 0 ? static_cast<double>(simulated_time.count()) / static_cast<double>(wall_time.count()) : 0.0;
+            }
+        };
+
+        /** Create a simulation. The virtual time of the calling thread is reset to the epoch.
+         *
+         * @param seed The seed of the random generator of the simulation.
+         */
+        explicit FsmSimulator(std::uint64_t seed = 0) : generator(seed)
+        {
+            VirtualClock::reset();
+            scheduler.set_min_update_period(resolution);
+            stats.seeds = 1;
+        }
+
+        FsmSimulator(const FsmSimulator&) = delete;
+        FsmSimulator& operator=(const FsmSimulator&) = delete;
+
+        /** Add an instance to the simulation. It is updated from the current virtual time, at the update period of its current state.
+         *
+         * @param fsm The instance, started. It must outlive the runs of the simulation.
+         */
+        void add(Fsm& fsm)
+        {
+            instances.push_back({&fsm, fsm.transitions_count()});
+            scheduler.add(fsm, VirtualClock::now());
+        }
+
+        /** Update an instance at the current virtual time, e.g. after an event changed its state and therefore its update period.
+         *
+         * @param fsm The instance, previously added. Its previous deadline is dropped.
+         */
+        void wake(Fsm& fsm) { scheduler.add(fsm, VirtualClock::now()); }
+
+        /** Schedule an event after a delay, in virtual time.
+         *
+         * @param delay The delay from the current virtual time.
+         * @param event The event, called on the thread running the simulation. It may initiate transitions and schedule other events.
+         */
+        void schedule(duration delay, std::function<void()> event) { schedule_at(VirtualClock::now() + delay, std::move(event)); }
+
+        /** Schedule an event at a virtual time. An event in the past is called at the next step. */
+        void schedule_at(time_point time, std::function<void()> event)
+        {
+            events_queue.push({time, ++last_sequence, std::move(event)});
+        }
+
+        /** Count a latency measured by the simulated code, in virtual time. */
+        void record_latency(duration latency) { stats.latencies.record(latency); }
+
+        /** Get the random generator of the simulation, seeded by its seed. */
+        std::mt19937_64& random() { return generator; }
+
+        /** Set the minimum step of the virtual time to update the instances whose current state has no update period (1 ms by default). */
+        void set_resolution(duration step)
+        {
+            resolution = step;
+            scheduler.set_min_update_period(step);
+        }
+
+        /** Run the simulation until a virtual time.
+         *
+         * @param end The virtual time at which the simulation stops. The events and updates due at this time are run.
+         * @return The statistics of the simulation, since its creation.
+         */
+        const Stats& run_until(time_point end)
+        {
+            auto wall_start = std::chrono::steady_clock::now();
+            auto simulation_start = VirtualClock::now();
+
+            for (;;)
+            {
+                auto now = VirtualClock::now();
+                auto next = end + duration(1);
+
+                if (!events_queue.empty())
+                    next = std::min(next, std::max(events_queue.top().time, now));
+
+                if (auto deadline = scheduler.next_deadline())
+                {
+                    // An instance due again at the time of the last update (null update period) waits for the next resolution step
+                    auto due = updated_once && *deadline <= last_update_time ? last_update_time + resolution : *deadline;
+                    next = std::min(next, std::max(due, now));
+                }
+
+                if (next > end)
+                    break;
+
+                VirtualClock::advance_to(next);
+                now = VirtualClock::now();
+
+                while (!events_queue.empty() && events_queue.top().time <= now)
+                {
+                    auto event = std::move(const_cast<Event&>(events_queue.top()).function);
+                    events_queue.pop();
+                    ++stats.events;
+                    event();
+                }
+
+                if (!updated_once || now > last_update_time)
+                {
+                    scheduler.run_due(now);
+                    last_update_time = now;
+                    updated_once = true;
+                }
+            }
+
+            VirtualClock::advance_to(end);
+
+            for (auto& instance : instances)
+            {
+                auto transitions = instance.fsm->transitions_count();
+                stats.transitions += transitions - instance.transitions;
+                instance.transitions = transitions;
+            }
+
+            const auto& scheduler_stats = scheduler.get_stats();
+            stats.updates = scheduler_stats.updates;
+            stats.deadline_misses = scheduler_stats.deadline_misses;
+            stats.max_lateness = scheduler_stats.max_lateness;
+            stats.simulated_time += VirtualClock::now() - simulation_start;
+            stats.wall_time += std::chrono::steady_clock::now() - wall_start;
+            return stats;
+        }
+
+        /** Run the simulation for a virtual duration, from the current virtual time. */
+        const Stats& run_for(duration simulated) { return run_until(VirtualClock::now() + simulated); }
+
+        /** Get the statistics of the simulation. */
+        const Stats& get_stats() const { return stats; }
+
+        /** Run independent simulations in parallel, one per seed, and merge their statistics.
+         *
+         * Each simulation runs on a worker thread of the pool: it is created with its seed, set up by the setup function, which builds its
+         * fleet and schedules its first events, then run for the simulated duration. The fleet returned by the setup function is destroyed
+         * after the run.
+         *
+         * @param pool The thread pool running the simulations.
+         * @param seeds The seeds of the simulations.
+         * @param simulated The virtual duration of each simulation.
+         * @param setup The function building the fleet of a simulation, called as setup(simulator) on the worker thread, concurrently for
+         *              the different seeds. It returns the object owning the fleet (e.g. a std::unique_ptr).
+         * @return The merged statistics, in seed order. The wall time is the real time of the whole parallel run.
+         * @throw The first exception thrown by a simulation, in seed order.
+         */
+        template <typename Setup>
+        static Stats run_seeds(ThreadPool& pool, const std::vector<std::uint64_t>& seeds, duration simulated, Setup setup)
+        {
+            auto wall_start = std::chrono::steady_clock::now();
+
+            std::vector<std::future<Stats>> results;
+            results.reserve(seeds.size());
+            for (auto seed : seeds)
+            {
+                results.push_back(pool.submit([seed, simulated, &setup]()
+                {
+                    FsmSimulator simulator(seed);
+                    [[maybe_unused]] auto fleet = setup(simulator);
+                    return simulator.run_for(simulated);
+                }));
+            }
+
+            Stats merged;
+            std::exception_ptr error;
+            for (auto& result : results)
+            {
+                try
+                {
+                    merged.merge(result.get());
+                }
+                catch (...)
+                {
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+
+            if (error)
+                std::rethrow_exception(error);
+
+            merged.wall_time = std::chrono::steady_clock::now() - wall_start;
+            return merged;
+        }
+
+    private:
+
+        struct Event
+        {
+            time_point time;
+            std::uint64_t sequence;
+            std::function<void()> function;
+
+            bool operator>(const Event& other) const { return time != other.time ? time > other.time : sequence > other.sequence; }
+        };
+
+        struct Instance
+        {
+            Fsm* fsm;
+            std::uint64_t transitions;     // transitions count at the last statistics
+        };
+
+        FsmScheduler<VirtualClock> scheduler;
+        std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events_queue;
+        std::uint64_t last_sequence = 0;
+        std::vector<Instance> instances;
+        std::mt19937_64 generator;
+        duration resolution = std::chrono::milliseconds(1);
+        time_point last_update_time{};
+        bool updated_once = false;
+        Stats stats;
+    };
+}
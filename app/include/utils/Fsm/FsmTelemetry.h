@@ -0,0 +1,316 @@
+#pragma once
+
+#include <utils/Fsm/Fsm.h>
+#include <utils/Fsm/FsmTelemetrySlot.h>
+#include <utils/Tsc/Tsc.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Implementation Details
+
+    The telemetry of a fleet of FSM instances is published in a POSIX shared memory segment (shm_open), made of a header followed by an
+    array of telemetry slots (see FsmTelemetrySlot):
+
+        | header: magic, version, capacity, Tsc ticks per ns | slot 0 | slot 1 | ... | slot capacity - 1 |
+
+    FsmTelemetry creates the segment and attaches the instances to its free slots. Each instance then writes its own slot at each
+    transition, without lock and without system call, so that the monitoring does not disturb the update loop. The slots are aligned on
+    cache lines: the instances updated by different threads do not share cache lines.
+
+    FsmTelemetryReader maps the segment read-only, in any process, and copies the slots in use with the seqlock protocol. The monitoring
+    tool fsm_telemetry_reader is built on it.
+
+    FsmTelemetry keeps the instance attached to each slot, and the instance notifies it when it frees its slot (see
+    Fsm::set_telemetry_slot()). The destructor detaches the instances still attached before unmapping the segment, so that an instance
+    outliving the telemetry stops writing to it instead of writing (or freeing its slot, when destroyed) in unmapped memory.
+
+    The segment is unlinked when FsmTelemetry is destroyed; the readers which already mapped it keep their mapping until they close it.
+    The segment is created exclusively: an existing segment with the same name may be owned by another live process, so it is never
+    replaced silently. A segment left by a crashed process is removed explicitly (see FsmTelemetry::remove_segment()).
+
+*/
+
+namespace app::utils
+{
+
+    /** Header of a telemetry segment */
+    struct FsmTelemetryHeader
+    {
+        static constexpr std::uint64_t expected_magic = 0x314d4c54204d5346;     // "FSM TLM1"
+        static constexpr std::uint64_t expected_version = 1;
+
+        std::uint64_t magic;
+        std::uint64_t version;
+        std::uint64_t capacity;
+        double ticks_per_ns;    ///< rate of the Tsc timestamps of the slots
+
+        /** Size of a segment of a given capacity */
+        static std::size_t segment_size(std::size_t capacity)
+        {
+            return slots_offset + capacity * sizeof(FsmTelemetrySlot);
+        }
+
+        /** Offset of the slots in the segment */
+        static constexpr std::size_t slots_offset = (sizeof(std::uint64_t) * 3 + sizeof(double) + alignof(FsmTelemetrySlot) - 1)
+                                                    / alignof(FsmTelemetrySlot) * alignof(FsmTelemetrySlot);
+    };
+
+    /** This component publishes the current state and counters of FSM instances in a shared memory segment, for out-of-process monitoring. */
+    class FsmTelemetry
+    {
+    public:
+
+        /** Create the telemetry segment.
+         *
+         * @param name The name of the POSIX shared memory segment, e.g. "/my_app_fsm".
+         * @param capacity The maximum number of attached instances.
+         * @throw std::system_error if the segment cannot be created (EEXIST if a segment with the same name exists) or mapped.
+         */
+        FsmTelemetry(std::string name, std::size_t capacity) : segment_name(std::move(name)), slots_capacity(capacity), attached_instances(capacity, nullptr)
+        {
+            size = FsmTelemetryHeader::segment_size(capacity);
+
+            int fd = shm_open(segment_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), "shm_open");
+
+            if (ftruncate(fd, static_cast<off_t>(size)) < 0)
+            {
+                int error = errno;
+                close(fd);
+                shm_unlink(segment_name.c_str());
+                throw std::system_error(error, std::generic_category(), "ftruncate");
+            }
+
+            segment = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            int error = errno;
+            close(fd);
+            if (segment == MAP_FAILED)
+            {
+                shm_unlink(segment_name.c_str());
+                throw std::system_error(error, std::generic_category(), "mmap");
+            }
+
+            auto* base = static_cast<std::byte*>(segment);
+            slots = reinterpret_cast<FsmTelemetrySlot*>(base + FsmTelemetryHeader::slots_offset);
+            for (std::size_t i = 0; i < capacity; ++i)
+                new (&slots[i]) FsmTelemetrySlot();
+
+            auto* header = new (segment) FsmTelemetryHeader();
+            header->version = FsmTelemetryHeader::expected_version;
+            header->capacity = capacity;
+            header->ticks_per_ns = Tsc::ticks_per_ns();
+            header->magic = FsmTelemetryHeader::expected_magic;
+        }
+
+        FsmTelemetry(const FsmTelemetry&) = delete;
+        FsmTelemetry& operator=(const FsmTelemetry&) = delete;
+
+        /** Remove a segment left by a process which did not destroy its telemetry (e.g. a crashed process).
+         *
+         * The process owning the segment, if still alive, keeps writing to its mapping, but the readers cannot map it anymore.
+         *
+         * @param name The name of the POSIX shared memory segment.
+         * @return True if the segment has been removed, false if it does not exist.
+         */
+        static bool remove_segment(const std::string& name) { return shm_unlink(name.c_str()) == 0; }
+
+        /** Detach the instances still attached, then unmap and unlink the segment.
+         *
+         * As the detach, it must not run while the attached instances are updated on other threads.
+         */
+        ~FsmTelemetry()
+        {
+            for (auto* fsm : attached_instances)
+            {
+                if (fsm)
+                    fsm->set_telemetry_slot(nullptr);
+            }
+
+            munmap(segment, size);
+            shm_unlink(segment_name.c_str());
+        }
+
+        /** Attach an instance to a free slot: its current state is published at once, then at each transition.
+         *
+         * The instances are attached, detached and destroyed on the thread owning the telemetry. They can be updated on other threads.
+         *
+         * @param fsm The instance. It is detached when destroyed.
+         * @throw std::runtime_error if all the slots are in use.
+         */
+        void attach(Fsm& fsm)
+        {
+            if (fsm.get_telemetry_slot())
+                return;
+
+            for (std::size_t i = 0; i < slots_capacity; ++i)
+            {
+                auto index = (next_slot + i) % slots_capacity;
+                if (slots[index].in_use.load(std::memory_order_relaxed))
+                    continue;
+
+                next_slot = (index + 1) % slots_capacity;
+                attached_instances[index] = &fsm;
+                fsm.set_telemetry_slot(&slots[index], [this, index]() { attached_instances[index] = nullptr; });
+                return;
+            }
+
+            throw std::runtime_error("No free telemetry slot in " + segment_name);
+        }
+
+        /** Detach an instance: the readers stop reporting it. */
+        void detach(Fsm& fsm)
+        {
+            fsm.set_telemetry_slot(nullptr);
+        }
+
+        /** Get the name of the segment. */
+        const std::string& name() const { return segment_name; }
+
+        /** Get the maximum number of attached instances. */
+        std::size_t capacity() const { return slots_capacity; }
+
+    private:
+
+        std::string segment_name;
+        std::size_t slots_capacity;
+        std::size_t size = 0;
+        void* segment = nullptr;
+        FsmTelemetrySlot* slots = nullptr;
+        std::size_t next_slot = 0;
+        std::vector<Fsm*> attached_instances;    // instance attached to each slot, nullptr if free
+    };
+
+    /** This component reads the telemetry segment published by FsmTelemetry, in any process. */
+    class FsmTelemetryReader
+    {
+    public:
+
+        /** Map a telemetry segment read-only.
+         *
+         * @param name The name of the POSIX shared memory segment.
+         * @throw std::system_error if the segment cannot be opened or mapped.
+         * @throw std::runtime_error if the segment is not a telemetry segment.
+         */
+        explicit FsmTelemetryReader(const std::string& name)
+        {
+            int fd = shm_open(name.c_str(), O_RDONLY, 0);
+            if (fd < 0)
+                throw std::system_error(errno, std::generic_category(), "shm_open");
+
+            struct stat status;
+            if (fstat(fd, &status) < 0)
+            {
+                int error = errno;
+                close(fd);
+                throw std::system_error(error, std::generic_category(), "fstat");
+            }
+
+            size = static_cast<std::size_t>(status.st_size);
+            if (size < FsmTelemetryHeader::slots_offset)
+            {
+                close(fd);
+                throw std::runtime_error("Invalid telemetry segment " + name);
+            }
+
+            segment = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            int error = errno;
+            close(fd);
+            if (segment == MAP_FAILED)
+                throw std::system_error(error, std::generic_category(), "mmap");
+
+            header = static_cast<const FsmTelemetryHeader*>(segment);
+            if (header->magic != FsmTelemetryHeader::expected_magic || header->version != FsmTelemetryHeader::expected_version
+                || FsmTelemetryHeader::segment_size(header->capacity) > size)
+            {
+                munmap(segment, size);
+                throw std::runtime_error("Invalid telemetry segment " + name);
+            }
+
+            slots = reinterpret_cast<const FsmTelemetrySlot*>(static_cast<const std::byte*>(segment) + FsmTelemetryHeader::slots_offset);
+        }
+
+        FsmTelemetryReader(const FsmTelemetryReader&) = delete;
+        FsmTelemetryReader& operator=(const FsmTelemetryReader&) = delete;
+
+        ~FsmTelemetryReader()
+        {
+            munmap(segment, size);
+        }
+
+        /** Copy the slots in use.
+         *
+         * @return The telemetry of the attached instances, each consistent with one transition, except the torn slots (see FsmTelemetrySlot::read()).
+         */
+        std::vector<FsmTelemetrySnapshot> snapshot() const
+        {
+            std::vector<FsmTelemetrySnapshot> snapshots;
+            FsmTelemetrySnapshot slot_snapshot;
+
+            for (std::size_t i = 0; i < header->capacity; ++i)
+            {
+                if (slots[i].read(slot_snapshot))
+                    snapshots.push_back(slot_snapshot);
+            }
+            return snapshots;
+        }
+
+        /** Count the attached instances per current state.
+         *
+         * @return The number of instances per state name ("state_<id>" for the states without name, "torn" for the torn slots).
+         */
+        std::map<std::string, std::size_t> state_distribution() const { return state_distribution(snapshot()); }
+
+        /** Count the instances of a snapshot per current state, consistently with the number of instances of the snapshot.
+         *
+         * @param snapshots The telemetry of the instances, as copied by snapshot().
+         * @return The number of instances per state name ("state_<id>" for the states without name, "torn" for the torn slots).
+         */
+        static std::map<std::string, std::size_t> state_distribution(const std::vector<FsmTelemetrySnapshot>& snapshots)
+        {
+            std::map<std::string, std::size_t> distribution;
+            for (const auto& instance : snapshots)
+                ++distribution[state_label(instance)];
+            return distribution;
+        }
+
+        /** Get the time elapsed since the last transition of an instance. */
+        std::chrono::nanoseconds time_in_state(const FsmTelemetrySnapshot& instance) const
+        {
+            auto now = Tsc::now();
+            auto ticks = now > instance.transition_ticks ? now - instance.transition_ticks : 0;
+            return std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(static_cast<double>(ticks) / header->ticks_per_ns));
+        }
+
+        /** Get the label of the current state of an instance: its name, "state_<id>" for the states without name, or "torn" for a torn slot. */
+        static std::string state_label(const FsmTelemetrySnapshot& instance)
+        {
+            if (instance.torn)
+                return "torn";
+            return instance.state_name.empty() ? "state_" + std::to_string(static_cast<unsigned int>(instance.state)) : instance.state_name;
+        }
+
+        /** Get the maximum number of attached instances. */
+        std::size_t capacity() const { return header->capacity; }
+
+    private:
+
+        std::size_t size = 0;
+        void* segment = nullptr;
+        const FsmTelemetryHeader* header = nullptr;
+        const FsmTelemetrySlot* slots = nullptr;
+    };
+}
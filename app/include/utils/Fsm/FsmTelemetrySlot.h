@@ -0,0 +1,177 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include <utils/Tsc/Tsc.h>
+
+/* Implementation Details
+
+    A telemetry slot mirrors the current state of one FSM instance. It lives in a shared memory segment and is written by the thread of
+    the instance only, and read by any number of readers, in this process or in another one.
+
+    The slot is protected by a sequence lock (seqlock): the writer makes the sequence odd, stores the fields, then makes the sequence even
+    again. A reader copies the fields between two reads of the sequence, and retries if the sequence was odd or has changed. The writer never
+    waits for the readers, and a transition costs a handful of relaxed stores.
+
+    The retries are bounded (max_read_attempts, yielding while the sequence is odd): a writer which crashed in the middle of a write leaves
+    the sequence odd forever, and must not hang the readers. The last copy is then returned flagged as torn.
+
+    All the fields are lock-free 64-bit atomics, so that the concurrent accesses are well defined, across processes too. The name of the
+    state is copied (truncated to name_size characters) so that a reader in another process does not need the enumerations of the machine.
+
+*/
+
+namespace app::utils
+{
+
+    /** Copy of a telemetry slot, consistent with one transition. */
+    struct FsmTelemetrySnapshot
+    {
+        int state = 0;                          ///< identifier of the current state (StateId::value())
+        std::string state_name;                 ///< name of the current state, empty if unknown
+        std::uint64_t transition_ticks = 0;     ///< timestamp of the last transition, in Tsc ticks
+        std::uint64_t transitions = 0;          ///< number of transitions since the instance was attached
+        std::uint64_t updates = 0;              ///< number of updates since the instance was attached
+        bool torn = false;                      ///< true if no consistent copy could be read (e.g. the writer crashed while writing)
+    };
+
+    /** This component stores the telemetry of one FSM instance, written without lock and read consistently with a sequence lock. */
+    struct alignas(64) FsmTelemetrySlot
+    {
+        /** Maximum number of characters of the published state names */
+        static constexpr std::size_t name_size = 24;
+
+        /** Maximum number of copies tried by read() before reporting the slot as torn */
+        static constexpr std::size_t max_read_attempts = 1024;
+
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "The telemetry requires lock-free 64-bit atomics");
+
+        std::atomic<std::uint64_t> sequence{0};
+        std::atomic<std::uint64_t> in_use{0};
+        std::atomic<std::uint64_t> state{0};
+        std::atomic<std::uint64_t> transition_ticks{0};
+        std::atomic<std::uint64_t> transitions{0};
+        std::atomic<std::uint64_t> updates{0};
+        std::array<std::atomic<std::uint64_t>, name_size / 8> name{};
+
+        /** Publish a transition (writer only).
+         *
+         * @param state_id The value of the new current state.
+         * @param state_name The name of the new current state.
+         * @param ticks The timestamp of the transition.
+         */
+        void publish(int state_id, std::string_view state_name, std::uint64_t ticks)
+        {
+            begin_write();
+            store_state(state_id, state_name, ticks);
+            transitions.store(transitions.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            end_write();
+        }
+
+        /** Publish a transition timestamped now (writer only). */
+        void publish(int state_id, std::string_view state_name) { publish(state_id, state_name, Tsc::now()); }
+
+        /** Count an update (writer only). The counter is not part of the seqlock: a reader may see it one update ahead. */
+        void count_update()
+        {
+            updates.store(updates.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        /** Take the slot for an instance (writer only), publishing its current state with null counters. */
+        void attach(int state_id, std::string_view state_name, std::uint64_t ticks)
+        {
+            begin_write();
+            in_use.store(1, std::memory_order_relaxed);
+            store_state(state_id, state_name, ticks);
+            transitions.store(0, std::memory_order_relaxed);
+            updates.store(0, std::memory_order_relaxed);
+            end_write();
+        }
+
+        /** Take the slot for an instance (writer only), timestamping its current state now. */
+        void attach(int state_id, std::string_view state_name) { attach(state_id, state_name, Tsc::now()); }
+
+        /** Free the slot (writer only): the readers ignore it. */
+        void detach()
+        {
+            begin_write();
+            in_use.store(0, std::memory_order_relaxed);
+            end_write();
+        }
+
+        /** Read a consistent copy of the slot (any thread, any process).
+         *
+         * After max_read_attempts inconsistent copies, the last copy is returned with snapshot.torn set.
+         *
+         * @param snapshot The copy of the slot, filled if the slot is in use.
+         * @return True if the slot is in use (or torn), false otherwise.
+         */
+        bool read(FsmTelemetrySnapshot& snapshot) const
+        {
+            std::array<std::uint64_t, name_size / 8> words{};
+            std::uint64_t used = 0;
+
+            snapshot.torn = true;
+            for (std::size_t attempt = 0; attempt < max_read_attempts; ++attempt)
+            {
+                auto begin = sequence.load(std::memory_order_acquire);
+
+                used = in_use.load(std::memory_order_relaxed);
+                snapshot.state = static_cast<int>(static_cast<std::uint32_t>(state.load(std::memory_order_relaxed)));
+                snapshot.transition_ticks = transition_ticks.load(std::memory_order_relaxed);
+                snapshot.transitions = transitions.load(std::memory_order_relaxed);
+                for (std::size_t i = 0; i < words.size(); ++i)
+                    words[i] = name[i].load(std::memory_order_relaxed);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (!(begin & 1) && sequence.load(std::memory_order_relaxed) == begin)
+                {
+                    snapshot.torn = false;
+                    break;
+                }
+
+                // Let a preempted writer finish its write
+                if (begin & 1)
+                    std::this_thread::yield();
+            }
+
+            snapshot.updates = updates.load(std::memory_order_relaxed);
+
+            const auto* characters = reinterpret_cast<const char*>(words.data());
+            snapshot.state_name.assign(characters, strnlen(characters, name_size));
+            return used != 0 || snapshot.torn;
+        }
+
+    private:
+
+        void store_state(int state_id, std::string_view state_name, std::uint64_t ticks)
+        {
+            std::array<std::uint64_t, name_size / 8> words{};
+            if (!state_name.empty())
+                std::memcpy(words.data(), state_name.data(), std::min(state_name.size(), name_size));
+
+            state.store(static_cast<std::uint32_t>(state_id), std::memory_order_relaxed);
+            transition_ticks.store(ticks, std::memory_order_relaxed);
+            for (std::size_t i = 0; i < words.size(); ++i)
+                name[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        void begin_write()
+        {
+            sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+
+        void end_write()
+        {
+            sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+    };
+}
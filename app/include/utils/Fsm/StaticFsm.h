@@ -0,0 +1,234 @@
+#pragma once
+
+#include <utils/Fsm/Fsm.h>
+
+#include <type_traits>
+
+/* Implementation Details
+
+    Compile-time FSM description
+    ----------------------------
+
+    A machine is described by a single type: a transition table made of rows. Each row gives the source state, the event, the destination
+    state, and optionally a guard and an action:
+
+    .. code:: cpp
+
+        enum struct Door { Closed, Open, Locked };
+
+        struct OpenEvent {};
+        struct CloseEvent {};
+        struct LockEvent { int code; };
+
+        struct CodeIsValid { bool operator()(DoorContext& context, const LockEvent& event) const { return event.code == context.code; } };
+        struct Beep        { void operator()(DoorContext& context) const { context.beeps++; } };
+
+        using DoorTable = TransitionTable<
+            Row<Door::Closed, OpenEvent,  Door::Open>,
+            Row<Door::Open,   CloseEvent, Door::Closed, NoGuard,     Beep>,
+            Row<Door::Closed, LockEvent,  Door::Locked, CodeIsValid>
+        >;
+
+        DoorContext context;
+        StaticFsm<DoorTable, DoorContext> door(context, Door::Closed);
+        door.process_event(OpenEvent{});
+
+    Only the rows of the processed event are instantiated, and the dispatch is a chain of comparisons of the current state against constant
+    values, that the compiler turns into a switch or a jump table. There is no registration, no hashing and no allocation: the machine is
+    a single enum value.
+
+    Guards and actions are default constructible callables, called with the context and the event, or with the context only.
+
+    Interoperability with Fsm
+    -------------------------
+
+    StaticFsmAdapter drives a Fsm with a transition table: it registers the states of the table (unless already registered) and, on each
+    event, initiates the transition of the matching row with Fsm::transition_to. The transition overrides and the state handler overrides
+    registered on the Fsm therefore still apply to the generated machine.
+
+    The action of a row is called in the source state, before Fsm::transition_to: it runs before the exit function of the source state,
+    not between the exit and the entry as in UML. Fsm::transition_to exits and enters in a single step, and a transition override may
+    change the destination state, so the action cannot be inserted between them. An action needing the entered state belongs to the
+    entry function of the destination state.
+
+*/
+
+namespace app::utils
+{
+
+    /** Guard of a row without condition */
+    struct NoGuard
+    {
+        template <typename... Args>
+        constexpr bool operator()(Args&&...) const { return true; }
+    };
+
+    /** Action of a row without behavior */
+    struct NoAction
+    {
+        template <typename... Args>
+        constexpr void operator()(Args&&...) const {}
+    };
+
+    /** Row of a transition table: on `Event`, if the current state is `From` and the `Guard` is true, call the `Action` and go to `To`. */
+    template <auto From, typename Event, auto To, typename Guard = NoGuard, typename Action = NoAction>
+    struct Row
+    {
+        static_assert(std::is_enum_v<decltype(From)>, "The source state must be an enum value");
+        static_assert(std::is_same_v<decltype(From), decltype(To)>, "The source and destination states must have the same type");
+
+        static constexpr auto from = From;
+        static constexpr auto to = To;
+        using event = Event;
+        using guard = Guard;
+        using action = Action;
+    };
+
+    /** Transition table describing a machine. The rows are evaluated in declaration order, the first matching row is taken. */
+    template <typename... Rows>
+    struct TransitionTable
+    {
+        static_assert(sizeof...(Rows) > 0, "A transition table requires at least one row");
+    };
+
+    namespace detail
+    {
+        template <typename Row, typename... Rows>
+        struct first_row { using type = Row; };
+
+        template <typename Callable, typename Context, typename Event>
+        constexpr decltype(auto) invoke_with_context(Context& context, const Event& event)
+        {
+            if constexpr (std::is_invocable_v<const Callable&, Context&, const Event&>)
+                return Callable{}(context, event);
+            else
+                return Callable{}(context);
+        }
+
+        /* Call the action of a row and return true if the row matches the event, the current state and its guard */
+        template <typename Row, typename State, typename Context, typename Event>
+        constexpr bool take_row(State current_state, Context& context, const Event& event)
+        {
+            if constexpr (std::is_same_v<typename Row::event, Event>)
+            {
+                if (current_state == Row::from && invoke_with_context<typename Row::guard>(context, event))
+                {
+                    invoke_with_context<typename Row::action>(context, event);
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+
+    template <typename Table, typename Context>
+    class StaticFsm;
+
+    /** This component implements a Finite State Machine whose transitions are described at compile time by a transition table.
+     *
+     *  The dispatch code is generated from the table, so the machine has no startup cost: there is no state registration, and its state
+     *  is a single enum value.
+     */
+    template <typename... Rows, typename Context>
+    class StaticFsm<TransitionTable<Rows...>, Context>
+    {
+    public:
+
+        using state_type = std::remove_const_t<decltype(detail::first_row<Rows...>::type::from)>;
+
+        static_assert((std::is_same_v<std::remove_const_t<decltype(Rows::from)>, state_type> && ...), "All the rows must use the same state type");
+
+        constexpr StaticFsm(Context& context, state_type initial_state) : context(context), state(initial_state) {}
+
+        /** Process an event.
+         *
+         * The first row of the event whose source state is the current state and whose guard is true is taken: its action is called, then
+         * the current state is set to its destination state.
+         *
+         * @param event The event to process.
+         * @return True if a transition has been taken, false otherwise.
+         */
+        template <typename Event>
+        constexpr bool process_event(const Event& event)
+        {
+            state_type next_state = state;
+            bool taken = ((detail::take_row<Rows>(state, context, event) && (next_state = Rows::to, true)) || ...);
+            state = next_state;
+            return taken;
+        }
+
+        /** Get the current state of the machine. */
+        constexpr state_type current_state() const { return state; }
+
+        /** Check if the machine is in a given state. */
+        constexpr bool is_in_state(state_type state_id) const { return state == state_id; }
+
+    private:
+
+        Context& context;
+        state_type state;
+    };
+
+    template <typename Table, typename Context>
+    class StaticFsmAdapter;
+
+    /** Adapter driving a Fsm with a transition table.
+     *
+     *  The states of the table are registered in the Fsm with empty state functions, unless they are already registered. The events are
+     *  dispatched on the current state of the Fsm, and the transitions are initiated with Fsm::transition_to, so the transition overrides
+     *  and the state handler overrides of the Fsm apply.
+     */
+    template <typename... Rows, typename Context>
+    class StaticFsmAdapter<TransitionTable<Rows...>, Context>
+    {
+    public:
+
+        StaticFsmAdapter(Fsm& fsm, Context& context) : fsm(fsm), context(context)
+        {
+            (register_state_if_missing(Rows::from), ...);
+            (register_state_if_missing(Rows::to), ...);
+        }
+
+        /** Process an event.
+         *
+         * The first row of the event whose source state is the current state of the Fsm and whose guard is true is taken: its action is called,
+         * then the transition to its destination state is initiated on the Fsm. The action therefore runs before the exit function of the
+         * source state, not between the exit and the entry.
+         *
+         * @param event The event to process.
+         * @return True if a transition has been initiated, false otherwise (e.g. the Fsm is in a state which is not part of the table).
+         */
+        template <typename Event>
+        bool process_event(const Event& event)
+        {
+            return (take_row<Rows>(event) || ...);
+        }
+
+    private:
+
+        Fsm& fsm;
+        Context& context;
+
+        template <typename StateIdT>
+        void register_state_if_missing(StateIdT state_id)
+        {
+            if (!fsm.find_state(state_id).has_value())
+                fsm.register_state(state_id, nullptr, [](){}, nullptr);
+        }
+
+        template <typename Row, typename Event>
+        bool take_row(const Event& event)
+        {
+            if constexpr (std::is_same_v<typename Row::event, Event>)
+            {
+                if (fsm.is_in_state(Row::from) && detail::invoke_with_context<typename Row::guard>(context, event))
+                {
+                    detail::invoke_with_context<typename Row::action>(context, event);
+                    fsm.transition_to(Row::to);
+                    return true;
+                }
+            }
+            return false;
+        }
+    };
+}
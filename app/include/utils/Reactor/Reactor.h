@@ -0,0 +1,228 @@
+#pragma once
+
+#include <utils/Fsm/Fsm.h>
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <system_error>
+#include <unordered_map>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+/* Implementation Details
+
+    The reactor is built on epoll. The file descriptors are registered with the events to watch (EPOLLIN, EPOLLOUT...) and a handler.
+    poll() blocks the calling thread until at least one file descriptor is ready (so an idle application consumes no CPU), then calls
+    the handlers of all the ready file descriptors, as a batch, on the calling thread. The handlers typically initiate FSM transitions,
+    which replaces the busy polling of the file descriptors in the *on do* functions.
+
+    An eventfd is registered internally so that another thread can wake up a blocked poll().
+
+*/
+
+namespace app::utils
+{
+
+    /** This component implements an I/O reactor that delivers the readiness of file descriptors to handlers, on the thread calling poll().
+     *
+     *  A handler is registered for a file descriptor and a set of epoll events. When the file descriptor is ready, the handler is called
+     *  with the ready events. The handler can initiate a FSM transition, or add_transition() can bind the readiness to a transition.
+     */
+    class Reactor
+    {
+    public:
+
+        /** Handler called with the ready epoll events (EPOLLIN, EPOLLOUT, EPOLLHUP...) of a file descriptor */
+        using Handler = std::function<void(std::uint32_t events)>;
+
+        /** Maximum number of ready file descriptors dispatched by a single poll() */
+        static constexpr std::size_t max_batch_size = 64;
+
+        /** Create the reactor.
+         *
+         * @throw std::system_error if the epoll instance or the wake up eventfd cannot be created.
+         */
+        Reactor()
+        {
+            epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+            if (epoll_fd < 0)
+                throw std::system_error(errno, std::generic_category(), "epoll_create1");
+
+            wakeup_fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            if (wakeup_fd < 0)
+            {
+                auto error = errno;
+                ::close(epoll_fd);
+                throw std::system_error(error, std::generic_category(), "eventfd");
+            }
+
+            try
+            {
+                control(EPOLL_CTL_ADD, wakeup_fd, EPOLLIN);
+            }
+            catch (...)
+            {
+                ::close(wakeup_fd);
+                ::close(epoll_fd);
+                throw;
+            }
+        }
+
+        ~Reactor()
+        {
+            ::close(wakeup_fd);
+            ::close(epoll_fd);
+        }
+
+        Reactor(const Reactor&) = delete;
+        Reactor& operator=(const Reactor&) = delete;
+
+        /** Register a file descriptor.
+         *
+         * @param fd The file descriptor to watch. The reactor does not take its ownership.
+         * @param events The epoll events to watch (e.g. EPOLLIN, EPOLLOUT, EPOLLET).
+         * @param handler The handler called with the ready events.
+         * @throw std::system_error if the file descriptor cannot be registered (e.g. already registered).
+         */
+        void add(int fd, std::uint32_t events, Handler handler)
+        {
+            // The handler is stored first, so that a failure leaves neither a handler without registration nor the opposite
+            auto [it, inserted] = handlers.try_emplace(fd, std::make_shared<Handler>(std::move(handler)));
+            if (!inserted)
+                throw std::system_error(EEXIST, std::generic_category(), "epoll_ctl");
+
+            try
+            {
+                control(EPOLL_CTL_ADD, fd, events);
+            }
+            catch (...)
+            {
+                handlers.erase(it);
+                throw;
+            }
+        }
+
+        /** Register a file descriptor whose readiness initiates a FSM transition.
+         *
+         * When the file descriptor is ready, the transition to the provided state is initiated if the FSM is not already in this state.
+         * The handler of the destination state is in charge of consuming the data (or of unregistering the file descriptor),
+         * otherwise a level-triggered file descriptor keeps being reported as ready.
+         *
+         * @param fd The file descriptor to watch. The reactor does not take its ownership.
+         * @param events The epoll events to watch.
+         * @param fsm The FSM to drive. It must outlive the registration.
+         * @param state_id The state identifier to transition to.
+         * @throw std::system_error if the file descriptor cannot be registered.
+         */
+        template <typename StateIdT>
+        void add_transition(int fd, std::uint32_t events, Fsm& fsm, StateIdT state_id)
+        {
+            add(fd, events, [&fsm, state_id](std::uint32_t)
+            {
+                if (!fsm.is_in_state(state_id))
+                    fsm.transition_to(state_id);
+            });
+        }
+
+        /** Change the watched events of a registered file descriptor.
+         *
+         * @throw std::system_error if the file descriptor is not registered.
+         */
+        void modify(int fd, std::uint32_t events)
+        {
+            control(EPOLL_CTL_MOD, fd, events);
+        }
+
+        /** Unregister a file descriptor. It can be called from a handler, including for another file descriptor of the same batch.
+         *
+         * The file descriptor may already be closed: closing it has removed it from epoll, only its handler is left to remove.
+         *
+         * @throw std::system_error if the file descriptor is not registered, or if epoll fails to unregister it (the handler is removed anyway).
+         */
+        void remove(int fd)
+        {
+            auto it = handlers.find(fd);
+            if (it == handlers.end())
+                throw std::system_error(ENOENT, std::generic_category(), "epoll_ctl");
+            // The handler is removed first, so that the number of a closed file descriptor can be registered again once reused
+            handlers.erase(it);
+
+            epoll_event event{};
+            if (::epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, &event) < 0 && errno != EBADF && errno != ENOENT)
+                throw std::system_error(errno, std::generic_category(), "epoll_ctl");
+        }
+
+        /** Wait for ready file descriptors and call their handlers on the calling thread.
+         *
+         * @param timeout The maximum waiting duration, a negative duration waits without limit.
+         * @return The number of handlers called (0 on timeout or wake up).
+         * @throw std::system_error if the waiting fails.
+         */
+        std::size_t poll(std::chrono::milliseconds timeout = std::chrono::milliseconds(-1))
+        {
+            std::array<epoll_event, max_batch_size> events;
+
+            int ready = ::epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), timeout.count() < 0 ? -1 : static_cast<int>(timeout.count()));
+            if (ready < 0)
+            {
+                if (errno == EINTR)
+                    return 0;
+                throw std::system_error(errno, std::generic_category(), "epoll_wait");
+            }
+
+            std::size_t dispatched = 0;
+            for (int i = 0; i < ready; ++i)
+            {
+                if (events[i].data.fd == wakeup_fd)
+                {
+                    std::uint64_t count;
+                    [[maybe_unused]] auto result = ::read(wakeup_fd, &count, sizeof(count));
+                    continue;
+                }
+
+                auto it = handlers.find(events[i].data.fd);
+                if (it == handlers.end())
+                    continue;
+
+                // Keep the handler alive, even if it unregisters its own file descriptor
+                auto handler = it->second;
+                (*handler)(events[i].events);
+                ++dispatched;
+            }
+
+            return dispatched;
+        }
+
+        /** Wake up a blocked poll(). It can be called from any thread. */
+        void wakeup()
+        {
+            std::uint64_t one = 1;
+            [[maybe_unused]] auto result = ::write(wakeup_fd, &one, sizeof(one));
+        }
+
+        /** Get the number of registered file descriptors. */
+        std::size_t size() const { return handlers.size(); }
+
+    private:
+
+        int epoll_fd = -1;
+        int wakeup_fd = -1;
+        std::unordered_map<int, std::shared_ptr<Handler>> handlers;
+
+        void control(int operation, int fd, std::uint32_t events)
+        {
+            epoll_event event{};
+            event.events = events;
+            event.data.fd = fd;
+
+            if (::epoll_ctl(epoll_fd, operation, fd, &event) < 0)
+                throw std::system_error(errno, std::generic_category(), "epoll_ctl");
+        }
+    };
+}
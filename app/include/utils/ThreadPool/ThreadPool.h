@@ -0,0 +1,108 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/* Implementation Details
+
+    A fixed set of worker threads takes the submitted tasks from a shared FIFO queue, protected by a mutex. Each task is wrapped in a
+    std::packaged_task, so its result, or the exception it throws, is delivered to the caller through a std::future.
+
+    The destructor runs the pending tasks, then joins the workers.
+
+*/
+
+namespace app::utils
+{
+
+    /** This component runs tasks on a fixed set of worker threads. */
+    class ThreadPool
+    {
+    public:
+
+        /** Create the worker threads.
+         *
+         * @param threads The number of worker threads (at least 1), the number of hardware threads by default.
+         */
+        explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency())
+        {
+            if (threads == 0)
+                threads = 1;
+
+            for (std::size_t i = 0; i < threads; ++i)
+                workers.emplace_back([this]() { run_worker(); });
+        }
+
+        ~ThreadPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            condition.notify_all();
+
+            for (auto& worker : workers)
+                worker.join();
+        }
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        /** Submit a task.
+         *
+         * @param function The task, called without argument on a worker thread.
+         * @return The future of the result of the task. It rethrows the exception thrown by the task, if any.
+         */
+        template <typename Function>
+        auto submit(Function&& function) -> std::future<std::invoke_result_t<std::decay_t<Function>>>
+        {
+            using Result = std::invoke_result_t<std::decay_t<Function>>;
+
+            auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+            auto future = task->get_future();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                tasks.emplace_back([task]() { (*task)(); });
+            }
+            condition.notify_one();
+
+            return future;
+        }
+
+        /** Get the number of worker threads. */
+        std::size_t size() const { return workers.size(); }
+
+    private:
+
+        std::vector<std::thread> workers;
+        std::deque<std::function<void()>> tasks;
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool stopping = false;
+
+        void run_worker()
+        {
+            while (true)
+            {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    condition.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                    if (tasks.empty())
+                        return;
+
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+                task();
+            }
+        }
+    };
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define APP_UTILS_TSC_RDTSC 1
+#elif defined(_M_X64) || defined(_M_IX86)
+    #include <intrin.h>
+    #define APP_UTILS_TSC_RDTSC 1
+#endif
+
+/* Implementation Details
+
+    The time stamp counter (TSC) of x86 processors is read with a single instruction, which is much cheaper than a call to
+    std::chrono::steady_clock::now(). On modern processors it ticks at a constant rate, whatever the frequency of the core.
+
+    Its rate is calibrated once against std::chrono::steady_clock, on the first conversion between ticks and durations.
+    On other architectures, the ticks are the nanoseconds of std::chrono::steady_clock.
+
+*/
+
+namespace app::utils
+{
+
+    /** This component provides cheap timestamps, in ticks of the time stamp counter, and their conversion to durations. */
+    class Tsc
+    {
+    public:
+
+        /** Read the time stamp counter.
+         *
+         * @return The current timestamp, in ticks.
+         */
+        static std::uint64_t now()
+        {
+#if defined(APP_UTILS_TSC_RDTSC)
+            return __rdtsc();
+#else
+            return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+        }
+
+        /** Get the number of ticks per nanosecond, calibrated on the first call. */
+        static double ticks_per_ns()
+        {
+            static const double ratio = calibrate();
+            return ratio;
+        }
+
+        /** Convert a duration to a number of ticks. */
+        static std::uint64_t to_ticks(std::chrono::nanoseconds duration)
+        {
+            return static_cast<std::uint64_t>(static_cast<double>(duration.count()) * ticks_per_ns());
+        }
+
+        /** Convert a number of ticks to a duration. */
+        static std::chrono::nanoseconds to_duration(std::uint64_t ticks)
+        {
+            return std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(static_cast<double>(ticks) / ticks_per_ns()));
+        }
+
+    private:
+
+        static double calibrate()
+        {
+#if defined(APP_UTILS_TSC_RDTSC)
+            auto start_time = std::chrono::steady_clock::now();
+            auto start_ticks = now();
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+            auto end_ticks = now();
+            auto end_time = std::chrono::steady_clock::now();
+
+            auto elapsed_ns = std::chrono::duration<double, std::nano>(end_time - start_time).count();
+            return elapsed_ns > 0 ? static_cast<double>(end_ticks - start_ticks) / elapsed_ns : 1.0;
+#else
+            return 1.0;
+#endif
+        }
+    };
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+
+/* Implementation Details
+
+    The virtual clock provides the std::chrono clock interface (now(), time_point, duration), but its time only moves when it is set by
+    a simulation driver (see FsmSimulator). The code under simulation reads VirtualClock::now() instead of a real clock, e.g. through a
+    Clock template parameter like FsmScheduler<Clock>, so that the idle time between two events is skipped instead of waited for.
+
+    The time is thread local: the simulations running in parallel on different threads each have their own time, without synchronization.
+    The code of a simulation must therefore read the clock on the thread running the simulation.
+
+*/
+
+namespace app::utils
+{
+
+    /** This component is a clock whose time is set by a simulation driver, independently on each thread. */
+    class VirtualClock
+    {
+    public:
+
+        using duration = std::chrono::nanoseconds;
+        using rep = duration::rep;
+        using period = duration::period;
+        using time_point = std::chrono::time_point<VirtualClock>;
+        static constexpr bool is_steady = true;
+
+        /** Get the current virtual time of the calling thread. */
+        static time_point now() { return current; }
+
+        /** Move the virtual time of the calling thread forward to a time point. The time never goes backward.
+         *
+         * @param time The new time. Ignored if earlier than the current time.
+         */
+        static void advance_to(time_point time)
+        {
+            if (time > current)
+                current = time;
+        }
+
+        /** Move the virtual time of the calling thread forward by a duration. */
+        static void advance(duration elapsed) { advance_to(current + elapsed); }
+
+        /** Reset the virtual time of the calling thread (the epoch by default). */
+        static void reset(time_point time = time_point{}) { current = time; }
+
+    private:
+
+        static inline thread_local time_point current{};
+    };
+}
@@ -0,0 +1,96 @@
+#include <utils/Fsm/FsmTelemetry.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <thread>
+
+/* Monitoring tool of the FSM telemetry: maps a telemetry segment read-only and prints the distribution of the current states of the
+   attached instances, once or periodically. The monitored process is not disturbed: the tool never writes to the segment. */
+
+namespace
+{
+    void print_usage(const char* program)
+    {
+        std::fprintf(stderr, "usage: %s <segment> [--instances] [--watch <period_ms>]\n", program);
+        std::fprintf(stderr, "  <segment>       name of the telemetry segment, e.g. /my_app_fsm\n");
+        std::fprintf(stderr, "  --instances     print each instance, not only the state distribution\n");
+        std::fprintf(stderr, "  --watch <ms>    print the telemetry periodically, until interrupted\n");
+    }
+
+    void print_telemetry(const app::utils::FsmTelemetryReader& reader, bool instances)
+    {
+        // The distribution is computed from the same snapshot as the count, so that the percentages add up while the writers move,
+        // and an empty snapshot has no row to divide by zero
+        auto snapshots = reader.snapshot();
+
+        std::printf("%zu/%zu instances\n", snapshots.size(), reader.capacity());
+        for (const auto& [state, count] : app::utils::FsmTelemetryReader::state_distribution(snapshots))
+            std::printf("  %-32s %8zu %6.1f%%\n", state.c_str(), count, 100.0 * static_cast<double>(count) / static_cast<double>(snapshots.size()));
+
+        if (instances)
+        {
+            std::printf("  %-32s %12s %12s %14s\n", "state", "transitions", "updates", "time in state");
+            for (const auto& instance : snapshots)
+            {
+                auto time_in_state = std::chrono::duration<double, std::milli>(reader.time_in_state(instance)).count();
+                std::printf("  %-32s %12llu %12llu %11.3f ms\n", app::utils::FsmTelemetryReader::state_label(instance).c_str(),
+                    static_cast<unsigned long long>(instance.transitions), static_cast<unsigned long long>(instance.updates), time_in_state);
+            }
+        }
+        std::fflush(stdout);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::string segment = argv[1];
+    bool instances = false;
+    long watch_period_ms = 0;
+
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--instances") == 0)
+        {
+            instances = true;
+        }
+        else if (std::strcmp(argv[i], "--watch") == 0 && i + 1 < argc)
+        {
+            watch_period_ms = std::strtol(argv[++i], nullptr, 10);
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    try
+    {
+        app::utils::FsmTelemetryReader reader(segment);
+
+        print_telemetry(reader, instances);
+        while (watch_period_ms > 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(watch_period_ms));
+            std::printf("\n");
+            print_telemetry(reader, instances);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::fprintf(stderr, "%s: %s\n", segment.c_str(), e.what());
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,68 @@
+#include <MyModule.h>
+#include <utils/Reactor/Reactor.h>
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+
+#include <sys/signalfd.h>
+#include <unistd.h>
+
+int main()
+{
+    app::utils::Reactor reactor;
+    app::MyModule module;
+
+    // Stop on SIGINT / SIGTERM, delivered through the reactor
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    if (sigprocmask(SIG_BLOCK, &signals, nullptr) != 0)
+    {
+        std::perror("sigprocmask");
+        return EXIT_FAILURE;
+    }
+
+    int signal_fd = signalfd(-1, &signals, SFD_CLOEXEC);
+    if (signal_fd < 0)
+    {
+        std::perror("signalfd");
+        return EXIT_FAILURE;
+    }
+
+    bool running = true;
+    reactor.add(signal_fd, EPOLLIN, [&running](std::uint32_t) { running = false; });
+
+    // The modules register their own file descriptors in the reactor
+    module.init(reactor);
+    module.start();
+
+    // The application sleeps in the reactor until a file descriptor is ready or the next deadline of the modules is due. Without deadline,
+    // it blocks in the reactor without timeout, so that an idle application consumes no CPU.
+    while (running)
+    {
+        auto deadline = module.next_deadline();
+        if (deadline && std::chrono::steady_clock::now() >= *deadline)
+        {
+            module.update();
+            deadline = module.next_deadline();
+        }
+
+        if (!deadline)
+        {
+            reactor.poll();
+            continue;
+        }
+
+        auto timeout = std::chrono::ceil<std::chrono::milliseconds>(*deadline - std::chrono::steady_clock::now());
+        reactor.poll(std::max(timeout, std::chrono::milliseconds(0)));
+    }
+
+    module.stop();
+    close(signal_fd);
+
+    return EXIT_SUCCESS;
+}
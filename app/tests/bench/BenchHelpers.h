@@ -0,0 +1,27 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+namespace app::bench
+{
+    /** Run a function a number of times and print the median and best duration per run, divided by the number of items processed per run. */
+    inline double run_benchmark(const char* name, int runs, std::size_t items_per_run, const std::function<void()>& function)
+    {
+        std::vector<double> durations;
+
+        for (int run = 0; run < runs; ++run)
+        {
+            auto start = std::chrono::steady_clock::now();
+            function();
+            durations.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / static_cast<double>(items_per_run));
+        }
+
+        std::sort(durations.begin(), durations.end());
+        std::printf("%-40s median %10.2f ns/item   best %10.2f ns/item\n", name, durations[durations.size() / 2], durations.front());
+        return durations[durations.size() / 2];
+    }
+}
@@ -0,0 +1,100 @@
+#include "BenchHelpers.h"
+
+#include <utils/Fsm/FsmBatch.h>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+/* Compares the scalar polling of the guards in the *on do* functions with the batch evaluation of the guards.
+   Each instance toggles between the Idle and Active states depending on a level, regenerated for each round. */
+
+using app::utils::BatchGuard;
+using app::utils::BatchTransition;
+using app::utils::Fsm;
+using app::utils::FsmBatch;
+
+namespace
+{
+    enum struct BenchState
+    {
+        Idle,
+        Active
+    };
+
+    constexpr std::size_t fleet_size = 100000;
+    constexpr int rounds = 16;
+    constexpr float threshold = 0.5f;
+
+    std::vector<std::vector<float>> make_levels()
+    {
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+        std::vector<std::vector<float>> levels(rounds, std::vector<float>(fleet_size));
+        for (auto& round : levels)
+            for (auto& level : round)
+                level = distribution(generator);
+        return levels;
+    }
+}
+
+int main()
+{
+    auto levels = make_levels();
+    const float* current_levels = levels[0].data();
+
+    std::vector<std::unique_ptr<Fsm>> polled_fleet;
+    std::vector<std::unique_ptr<Fsm>> batched_fleet;
+    std::vector<Fsm*> batched_instances;
+
+    for (std::size_t i = 0; i < fleet_size; ++i)
+    {
+        auto fsm = std::make_unique<Fsm>();
+        auto* raw = fsm.get();
+        fsm->register_state(BenchState::Idle, nullptr, [raw, i, &current_levels](){ if (current_levels[i] > threshold) raw->transition_to(BenchState::Active); }, nullptr);
+        fsm->register_state(BenchState::Active, nullptr, [raw, i, &current_levels](){ if (current_levels[i] <= threshold) raw->transition_to(BenchState::Idle); }, nullptr);
+        fsm->set_initial_state(BenchState::Idle);
+        fsm->start();
+        polled_fleet.push_back(std::move(fsm));
+
+        auto batched = std::make_unique<Fsm>();
+        batched->register_state(BenchState::Idle, nullptr, [](){}, nullptr);
+        batched->register_state(BenchState::Active, nullptr, [](){}, nullptr);
+        batched->set_initial_state(BenchState::Idle);
+        batched->start();
+        batched_instances.push_back(batched.get());
+        batched_fleet.push_back(std::move(batched));
+    }
+
+    app::bench::run_benchmark("scalar on_do polling", rounds, fleet_size * rounds, [&]()
+    {
+        for (const auto& round : levels)
+        {
+            current_levels = round.data();
+            for (auto& fsm : polled_fleet)
+                fsm->update();
+        }
+    });
+
+    FsmBatch batch;
+    app::bench::run_benchmark("batch guard evaluation", rounds, fleet_size * rounds, [&]()
+    {
+        for (const auto& round : levels)
+        {
+            const BatchTransition transitions[] = {
+                {BenchState::Idle, BenchState::Active, {round.data(), BatchGuard::Comparison::Greater, threshold}},
+                {BenchState::Active, BenchState::Idle, {round.data(), BatchGuard::Comparison::LessEqual, threshold}},
+            };
+            batch.step(batched_instances, transitions);
+        }
+    });
+
+    std::vector<std::uint64_t> mask(FsmBatch::mask_size(fleet_size));
+    app::bench::run_benchmark("batch guard evaluation (mask only)", rounds, fleet_size * rounds, [&]()
+    {
+        for (const auto& round : levels)
+            FsmBatch::evaluate({round.data(), BatchGuard::Comparison::Greater, threshold}, fleet_size, mask.data());
+    });
+
+    return 0;
+}
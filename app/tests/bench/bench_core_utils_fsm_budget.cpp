@@ -0,0 +1,119 @@
+#include "BenchHelpers.h"
+
+#include <utils/Fsm/FsmBudgetedDriver.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+/* Reproduces a burst on a fleet of FSM instances: during a few ticks, a part of the fleet has an expensive update (e.g. a burst of
+   incoming messages). The tick latency (duration of a tick) is compared between a full pass over the fleet on each tick and the budgeted
+   driver, which spreads the burst over the next ticks. */
+
+using app::utils::Fsm;
+using app::utils::FsmBudgetedDriver;
+using app::utils::Tsc;
+
+namespace
+{
+    enum struct FleetState
+    {
+        Running
+    };
+
+    constexpr std::size_t fleet_size = 2000;
+    constexpr int ticks = 400;
+    constexpr int burst_start = 200;
+    constexpr int burst_ticks = 10;
+    constexpr std::size_t burst_stride = 2;             // one instance out of burst_stride is busy during the burst
+    constexpr std::uint64_t burst_work_ns = 2000;       // duration of a busy update
+
+    struct Instance
+    {
+        Fsm fsm;
+        int pending_work = 0;
+    };
+
+    std::vector<std::unique_ptr<Instance>> make_fleet()
+    {
+        const auto busy_ticks = Tsc::to_ticks(std::chrono::nanoseconds(burst_work_ns));
+
+        std::vector<std::unique_ptr<Instance>> fleet;
+        for (std::size_t i = 0; i < fleet_size; ++i)
+        {
+            auto instance = std::make_unique<Instance>();
+            auto* raw = instance.get();
+            instance->fsm.register_state(FleetState::Running, nullptr, [raw, busy_ticks]()
+            {
+                for (; raw->pending_work > 0; --raw->pending_work)
+                {
+                    auto end = Tsc::now() + busy_ticks;
+                    while (Tsc::now() < end) {}
+                }
+            }, nullptr);
+            instance->fsm.set_initial_state(FleetState::Running);
+            instance->fsm.start();
+            fleet.push_back(std::move(instance));
+        }
+        return fleet;
+    }
+
+    void report(const char* name, std::vector<double> latencies)
+    {
+        std::sort(latencies.begin(), latencies.end());
+        std::printf("%-40s median %10.0f ns   p99 %10.0f ns   max %10.0f ns\n", name,
+            latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100], latencies.back());
+    }
+
+    /* Run the scenario, calling tick_function on each tick, and return the tick latencies */
+    template <typename TickFunction>
+    std::vector<double> run_scenario(std::vector<std::unique_ptr<Instance>>& fleet, TickFunction tick_function)
+    {
+        std::vector<double> latencies;
+        latencies.reserve(ticks);
+
+        for (int tick = 0; tick < ticks; ++tick)
+        {
+            if (tick >= burst_start && tick < burst_start + burst_ticks)
+                for (std::size_t i = 0; i < fleet.size(); i += burst_stride)
+                    fleet[i]->pending_work++;
+
+            auto start = Tsc::now();
+            tick_function();
+            latencies.push_back(static_cast<double>(Tsc::to_duration(Tsc::now() - start).count()));
+        }
+        return latencies;
+    }
+}
+
+int main()
+{
+    {
+        auto fleet = make_fleet();
+        report("full pass per tick", run_scenario(fleet, [&fleet]()
+        {
+            for (auto& instance : fleet)
+                instance->fsm.update();
+        }));
+    }
+
+    for (auto budget_us : {500, 2000})
+    {
+        auto fleet = make_fleet();
+        FsmBudgetedDriver driver;
+        for (auto& instance : fleet)
+            driver.add(instance->fsm);
+
+        FsmBudgetedDriver::Budget budget;
+        budget.max_duration = std::chrono::microseconds(budget_us);
+
+        char name[64];
+        std::snprintf(name, sizeof(name), "budgeted driver (%d us)", budget_us);
+        report(name, run_scenario(fleet, [&driver, &budget]() { driver.tick(budget); }));
+        std::printf("%-40s exhausted ticks %llu / %llu\n", "", static_cast<unsigned long long>(driver.get_stats().exhausted_ticks),
+            static_cast<unsigned long long>(driver.get_stats().ticks));
+    }
+
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include "BenchHelpers.h"
+
+#include <utils/Fsm/FsmRegistry.h>
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+/* Measures the churn of FSM instances: creating and destroying 1M machines, and replacing random machines of a live fleet. The generational
+   slot map of FsmRegistry is compared with a std::unordered_map<EntityId, std::unique_ptr<Fsm>>. */
+
+using app::utils::Fsm;
+using app::utils::FsmRegistry;
+
+namespace
+{
+    constexpr std::size_t machines = 1000000;
+    constexpr std::size_t live_fleet = 100000;
+
+    void print_rate(double ns_per_operation)
+    {
+        std::printf("%-40s %10.2f M operations/s\n", "", 1e3 / ns_per_operation);
+    }
+
+    /* Random indexes of the live fleet to replace, identical for both containers */
+    std::vector<std::size_t> make_victims()
+    {
+        std::mt19937 generator(42);
+        std::uniform_int_distribution<std::size_t> distribution(0, live_fleet - 1);
+        std::vector<std::size_t> victims(machines);
+        for (auto& victim : victims)
+            victim = distribution(generator);
+        return victims;
+    }
+}
+
+int main()
+{
+    const auto victims = make_victims();
+
+    {
+        FsmRegistry registry;
+        std::vector<FsmRegistry::Handle> handles(machines);
+
+        print_rate(app::bench::run_benchmark("registry create + destroy 1M", 5, 2 * machines, [&]()
+        {
+            for (auto& handle : handles)
+                handle = registry.create();
+            for (auto handle : handles)
+                registry.destroy(handle);
+        }));
+    }
+
+    {
+        std::unordered_map<std::uint64_t, std::unique_ptr<Fsm>> map;
+        std::uint64_t next_id = 0;
+
+        print_rate(app::bench::run_benchmark("unordered_map create + destroy 1M", 5, 2 * machines, [&]()
+        {
+            auto first_id = next_id;
+            for (std::size_t i = 0; i < machines; ++i)
+                map.emplace(next_id++, std::make_unique<Fsm>());
+            for (auto id = first_id; id < next_id; ++id)
+                map.erase(id);
+        }));
+    }
+
+    {
+        FsmRegistry registry;
+        std::vector<FsmRegistry::Handle> handles(live_fleet);
+        for (auto& handle : handles)
+            handle = registry.create();
+
+        print_rate(app::bench::run_benchmark("registry churn (100k live)", 5, 2 * machines, [&]()
+        {
+            for (auto victim : victims)
+            {
+                registry.destroy(handles[victim]);
+                handles[victim] = registry.create();
+            }
+        }));
+    }
+
+    {
+        std::unordered_map<std::uint64_t, std::unique_ptr<Fsm>> map;
+        std::vector<std::uint64_t> ids(live_fleet);
+        std::uint64_t next_id = 0;
+        for (auto& id : ids)
+        {
+            id = next_id++;
+            map.emplace(id, std::make_unique<Fsm>());
+        }
+
+        print_rate(app::bench::run_benchmark("unordered_map churn (100k live)", 5, 2 * machines, [&]()
+        {
+            for (auto victim : victims)
+            {
+                map.erase(ids[victim]);
+                ids[victim] = next_id++;
+                map.emplace(ids[victim], std::make_unique<Fsm>());
+            }
+        }));
+    }
+
+    return 0;
+}
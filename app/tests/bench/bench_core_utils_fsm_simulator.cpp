@@ -0,0 +1,114 @@
+#include <utils/Fsm/FsmSimulator.h>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+/* Measures the speed of the virtual-time simulation: a week of traffic on a fleet of 500 servers, each receiving a request every 10 min
+   on average (Poisson arrivals) and working 1 to 5 s on it, updated every 100 ms when busy and every minute when idle. 4 seeds are
+   simulated sequentially, then in parallel on a thread pool, and the aggregate statistics are printed. */
+
+using app::utils::Fsm;
+using app::utils::FsmSimulator;
+using app::utils::ThreadPool;
+using app::utils::VirtualClock;
+using namespace std::chrono_literals;
+
+namespace
+{
+    constexpr std::size_t servers = 500;
+    constexpr auto simulated_week = 24h * 7;
+
+    enum struct ServerState
+    {
+        Idle,
+        Busy
+    };
+
+    struct Server
+    {
+        Fsm fsm;
+        FsmSimulator& simulator;
+        VirtualClock::time_point request_time{};
+        int work_left = 0;
+
+        explicit Server(FsmSimulator& simulator) : simulator(simulator)
+        {
+            fsm.register_state(ServerState::Idle, Fsm::UpdatePeriod{1min}, nullptr, [](){}, nullptr);
+            fsm.register_state(ServerState::Busy, Fsm::UpdatePeriod{100ms}, nullptr, [this](){
+                if (--work_left <= 0)
+                {
+                    this->simulator.record_latency(VirtualClock::now() - request_time);
+                    fsm.transition_to(ServerState::Idle);
+                }
+            }, nullptr);
+            fsm.set_initial_state(ServerState::Idle);
+            fsm.start();
+            simulator.add(fsm);
+        }
+
+        /* Request arrival: serve it, then schedule the next arrival of this server */
+        void request()
+        {
+            auto& random = simulator.random();
+            if (fsm.is_in_state(ServerState::Idle))
+            {
+                request_time = VirtualClock::now();
+                work_left = std::uniform_int_distribution<int>(10, 50)(random);
+                fsm.transition_to(ServerState::Busy);
+                simulator.wake(fsm);
+            }
+
+            std::exponential_distribution<double> interval(1.0 / 600.0);
+            simulator.schedule(std::chrono::duration_cast<VirtualClock::duration>(std::chrono::duration<double>(interval(random))), [this]() { request(); });
+        }
+    };
+
+    std::unique_ptr<std::vector<std::unique_ptr<Server>>> setup(FsmSimulator& simulator)
+    {
+        auto fleet = std::make_unique<std::vector<std::unique_ptr<Server>>>();
+        for (std::size_t i = 0; i < servers; ++i)
+        {
+            auto* server = fleet->emplace_back(std::make_unique<Server>(simulator)).get();
+            simulator.schedule(0s, [server]() { server->request(); });
+        }
+        return fleet;
+    }
+
+    void print_stats(const char* name, const FsmSimulator::Stats& stats)
+    {
+        auto hours = std::chrono::duration<double, std::ratio<3600>>(stats.simulated_time).count();
+        auto seconds = std::chrono::duration<double>(stats.wall_time).count();
+        auto to_ms = [](VirtualClock::duration latency) { return std::chrono::duration<double, std::milli>(latency).count(); };
+
+        std::printf("%-40s %zu seeds, %.0f h simulated in %.2f s (x%.0f)\n", name, stats.seeds, hours, seconds, stats.speedup());
+        std::printf("%-40s %llu updates, %llu transitions, %llu events, %.1f M updates/s\n", "",
+            static_cast<unsigned long long>(stats.updates), static_cast<unsigned long long>(stats.transitions),
+            static_cast<unsigned long long>(stats.events), static_cast<double>(stats.updates) / seconds / 1e6);
+        std::printf("%-40s latency p50 %.0f ms, p99 %.0f ms, max %.0f ms\n", "",
+            to_ms(stats.latencies.percentile(50)), to_ms(stats.latencies.percentile(99)), to_ms(stats.latencies.max()));
+    }
+}
+
+int main()
+{
+    const std::vector<std::uint64_t> seeds = {1, 2, 3, 4};
+
+    FsmSimulator::Stats sequential;
+    for (auto seed : seeds)
+    {
+        FsmSimulator simulator(seed);
+        auto fleet = setup(simulator);
+        sequential.merge(simulator.run_for(simulated_week));
+    }
+    print_stats("1 week x 500 servers, sequential", sequential);
+
+    ThreadPool pool;
+    auto parallel = FsmSimulator::run_seeds(pool, seeds, simulated_week, setup);
+    std::printf("\n");
+    print_stats("1 week x 500 servers, thread pool", parallel);
+
+    return 0;
+}
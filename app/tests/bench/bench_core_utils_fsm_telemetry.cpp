@@ -0,0 +1,90 @@
+#include "BenchHelpers.h"
+
+#include <utils/Fsm/FsmTelemetry.h>
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+/* Measures the writer overhead of the telemetry: 1M transitions between 2 states, without telemetry, with a telemetry slot, then with a
+   telemetry slot read continuously by another thread (the cache line of the slot is then shared with the reader). */
+
+using app::utils::Fsm;
+using app::utils::FsmTelemetry;
+using app::utils::FsmTelemetryReader;
+
+namespace
+{
+    constexpr std::size_t transitions = 1000000;
+
+    enum struct BenchState
+    {
+        Ping,
+        Pong
+    };
+
+    void register_states(Fsm& fsm)
+    {
+        fsm.register_state(BenchState::Ping, nullptr, [](){}, nullptr);
+        fsm.register_state(BenchState::Pong, nullptr, [](){}, nullptr);
+        fsm.set_initial_state(BenchState::Ping);
+        fsm.start();
+    }
+
+    void run_transitions(Fsm& fsm)
+    {
+        for (std::size_t i = 0; i < transitions; i += 2)
+        {
+            fsm.transition_to(BenchState::Pong);
+            fsm.transition_to(BenchState::Ping);
+        }
+    }
+}
+
+int main()
+{
+    const auto segment = "/bench_fsm_telemetry_" + std::to_string(getpid());
+
+    {
+        Fsm fsm;
+        register_states(fsm);
+        app::bench::run_benchmark("transitions without telemetry", 5, transitions, [&]() { run_transitions(fsm); });
+    }
+
+    {
+        FsmTelemetry telemetry(segment, 1);
+        Fsm fsm;
+        register_states(fsm);
+        telemetry.attach(fsm);
+        app::bench::run_benchmark("transitions with telemetry", 5, transitions, [&]() { run_transitions(fsm); });
+    }
+
+    {
+        FsmTelemetry telemetry(segment, 1);
+        Fsm fsm;
+        register_states(fsm);
+        telemetry.attach(fsm);
+
+        std::atomic<bool> running{true};
+        std::size_t reads = 0;
+        std::thread reader_thread([&]()
+        {
+            FsmTelemetryReader reader(segment);
+            while (running.load(std::memory_order_relaxed))
+            {
+                reads += reader.snapshot().size();
+            }
+        });
+
+        app::bench::run_benchmark("transitions with telemetry, read", 5, transitions, [&]() { run_transitions(fsm); });
+
+        running = false;
+        reader_thread.join();
+        std::printf("%-40s %10zu snapshots read\n", "", reads);
+    }
+
+    return 0;
+}
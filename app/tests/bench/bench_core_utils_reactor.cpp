@@ -0,0 +1,96 @@
+#include "BenchHelpers.h"
+
+#include <utils/Reactor/Reactor.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+/* Measures the wake-to-transition latency of the reactor: a writer thread writes a byte on a socketpair or a pipe, the reactor thread
+   (blocked in poll) wakes up and the readiness initiates a FSM transition. The latency is measured from the write to the enter function
+   of the destination state. */
+
+using app::utils::Fsm;
+using app::utils::Reactor;
+
+namespace
+{
+    enum struct ChannelState
+    {
+        Idle,
+        Readable
+    };
+
+    constexpr int samples = 20000;
+
+    void measure(const char* name, int read_fd, int write_fd)
+    {
+        Reactor reactor;
+        Fsm fsm;
+        std::vector<double> latencies;
+        latencies.reserve(samples);
+        std::atomic<std::int64_t> written_at{0};
+        std::atomic<int> consumed{0};
+
+        auto now = []() { return std::chrono::steady_clock::now().time_since_epoch().count(); };
+
+        fsm.register_state(ChannelState::Idle, nullptr, [](){}, nullptr);
+        fsm.register_state(ChannelState::Readable, [&]()
+        {
+            latencies.push_back(static_cast<double>(now() - written_at.load()));
+            char byte;
+            [[maybe_unused]] auto result = ::read(read_fd, &byte, 1);
+            consumed.fetch_add(1);
+            fsm.transition_to(ChannelState::Idle);
+        }, [](){}, nullptr);
+        fsm.set_initial_state(ChannelState::Idle);
+        fsm.start();
+
+        reactor.add_transition(read_fd, EPOLLIN, fsm, ChannelState::Readable);
+
+        std::thread writer([&]()
+        {
+            for (int i = 0; i < samples; ++i)
+            {
+                while (consumed.load() != i)
+                    std::this_thread::yield();
+                written_at = now();
+                char byte = 1;
+                [[maybe_unused]] auto result = ::write(write_fd, &byte, 1);
+            }
+        });
+
+        while (consumed.load() < samples)
+            reactor.poll();
+        writer.join();
+
+        std::sort(latencies.begin(), latencies.end());
+        std::printf("%-40s median %10.0f ns   p99 %10.0f ns\n", name, latencies[latencies.size() / 2], latencies[latencies.size() * 99 / 100]);
+    }
+}
+
+int main()
+{
+    int sockets[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0)
+    {
+        measure("socketpair wake-to-transition", sockets[0], sockets[1]);
+        ::close(sockets[0]);
+        ::close(sockets[1]);
+    }
+
+    int pipe_fds[2];
+    if (::pipe(pipe_fds) == 0)
+    {
+        measure("pipe wake-to-transition", pipe_fds[0], pipe_fds[1]);
+        ::close(pipe_fds[0]);
+        ::close(pipe_fds[1]);
+    }
+
+    return 0;
+}
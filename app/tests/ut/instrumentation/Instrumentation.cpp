@@ -0,0 +1,60 @@
+#include "Instrumentation.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+/* Counting replacement of the global operator new, linked with the instrumented unit tests only.
+   The allocations are counted per thread, so that the allocations of the other threads do not disturb the assertions.
+   All the replaceable forms are replaced (plain, nothrow, aligned and aligned nothrow), so that no allocation escapes the count, and
+   each memory block is released by the matching replacement of operator delete. */
+
+namespace
+{
+    thread_local std::uint64_t allocations = 0;
+
+    void* allocate(std::size_t size)
+    {
+        ++allocations;
+        if (void* pointer = std::malloc(size ? size : 1))
+            return pointer;
+        throw std::bad_alloc();
+    }
+
+    void* allocate_aligned(std::size_t size, std::align_val_t alignment)
+    {
+        ++allocations;
+        auto align = std::max(static_cast<std::size_t>(alignment), sizeof(void*));
+        size = (std::max<std::size_t>(size, 1) + align - 1) / align * align;
+        if (void* pointer = std::aligned_alloc(align, size))
+            return pointer;
+        throw std::bad_alloc();
+    }
+}
+
+namespace app::ut
+{
+    std::uint64_t allocation_count() { return allocations; }
+}
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { try { return allocate(size); } catch (...) { return nullptr; } }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { try { return allocate(size); } catch (...) { return nullptr; } }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocate_aligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocate_aligned(size, alignment); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { try { return allocate_aligned(size, alignment); } catch (...) { return nullptr; } }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { try { return allocate_aligned(size, alignment); } catch (...) { return nullptr; } }
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept { std::free(pointer); }
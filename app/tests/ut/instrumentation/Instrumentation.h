@@ -0,0 +1,82 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <utils/Tsc/Tsc.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/* Instrumentation of the unit tests
+
+    The unit tests registered with the INSTRUMENTED option of dnfw_add_unittest are linked with a counting replacement of the global
+    operator new (see Instrumentation.cpp) and are compiled with UT_INSTRUMENTED defined. They can then assert that a statement does not
+    allocate (or bound its allocations), and that the median duration of a statement stays under a ceiling, in time stamp counter ticks (see app::utils::Tsc).
+
+    In a test which is not instrumented, the statement is executed without assertion.
+
+*/
+
+namespace app::ut
+{
+    /** Number of runs of a statement to compute its median duration */
+    inline constexpr int latency_runs = 1001;
+
+    /** Get the number of allocations (operator new calls) done by the calling thread since its start. */
+    std::uint64_t allocation_count();
+
+    /** Run a function a number of times and get the median of its durations, in time stamp counter ticks. */
+    template <typename Function>
+    std::uint64_t median_ticks(int runs, Function&& function)
+    {
+        std::vector<std::uint64_t> durations;
+        durations.reserve(runs);
+
+        for (int run = 0; run < runs; ++run)
+        {
+            auto start = app::utils::Tsc::now();
+            function();
+            durations.push_back(app::utils::Tsc::now() - start);
+        }
+
+        std::nth_element(durations.begin(), durations.begin() + runs / 2, durations.end());
+        return durations[runs / 2];
+    }
+}
+
+#if defined(UT_INSTRUMENTED)
+
+/** Expect a statement to do no allocation on the calling thread. */
+#define UT_EXPECT_NO_ALLOCATION(statement)                                                                  \
+    do                                                                                                      \
+    {                                                                                                       \
+        auto ut_allocations_before = ::app::ut::allocation_count();                                         \
+        statement;                                                                                          \
+        EXPECT_EQ(::app::ut::allocation_count() - ut_allocations_before, 0u) << "Allocations in: " #statement; \
+    } while (false)
+
+/** Expect a statement to do at most max_allocations allocations on the calling thread. */
+#define UT_EXPECT_ALLOCATIONS_LE(statement, max_allocations)                                               \
+    do                                                                                                      \
+    {                                                                                                       \
+        auto ut_allocations_before = ::app::ut::allocation_count();                                         \
+        statement;                                                                                          \
+        EXPECT_LE(::app::ut::allocation_count() - ut_allocations_before, static_cast<std::uint64_t>(max_allocations)) << "Allocations in: " #statement; \
+    } while (false)
+
+/** Expect the median duration of a statement, run latency_runs times, to be at most max_ticks time stamp counter ticks. */
+#define UT_EXPECT_MEDIAN_TICKS_LE(statement, max_ticks)                                                     \
+    do                                                                                                      \
+    {                                                                                                       \
+        auto ut_median_ticks = ::app::ut::median_ticks(::app::ut::latency_runs, [&]() { statement; });     \
+        EXPECT_LE(ut_median_ticks, static_cast<std::uint64_t>(max_ticks)) << "Median duration of: " #statement; \
+    } while (false)
+
+#else
+
+#define UT_EXPECT_NO_ALLOCATION(statement) do { statement; } while (false)
+#define UT_EXPECT_ALLOCATIONS_LE(statement, max_allocations) do { statement; } while (false)
+#define UT_EXPECT_MEDIAN_TICKS_LE(statement, max_ticks) do { statement; } while (false)
+
+#endif
@@ -1,8 +1,14 @@
-app::utils#include <gtest/gtest.h>
+#include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <utils/Fsm/Fsm.h>
+#include <Instrumentation.h>
 
-using dartnetfw::core::utils::Fsm;
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+using app::utils::Fsm;
 
 enum struct StateDefinition
 {
@@ -489,4 +495,946 @@ TEST(fsm, state_handler_override)
   
     fsm.start();
     while (fsm.update());
-}
\ No newline at end of file
+}
+enum struct GraphStateDefinition
+{
+    Init,
+    Running,
+    Done,
+    Orphan,
+    Inserted
+};
+
+/** @utdef{UT-FSM-0140 | The analysis of the declared transitions must report the unreachable states and the sink states without exit function}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0140, DNFW-SRS-FSM-0150
+
+    - GIVEN an fsm with declared transitions Init -> Running -> Done, and a registered Orphan state never targeted
+    -   AND the Done state has no exit function
+    - WHEN the fsm is analyzed
+    - THEN the Orphan state is reported as unreachable and the Done state is reported as a sink without exit function
+
+ @endut */
+TEST(fsm, analyze_reports_unreachable_states_and_sinks_without_exit)
+{
+    Fsm fsm;
+
+    fsm.register_state(GraphStateDefinition::Init, nullptr, [](){}, [](){});
+    fsm.register_state(GraphStateDefinition::Running, nullptr, [](){}, [](){});
+    fsm.register_state(GraphStateDefinition::Done, nullptr, [](){}, nullptr);
+    fsm.register_state(GraphStateDefinition::Orphan, nullptr, [](){}, [](){});
+
+    fsm.declare_transition(GraphStateDefinition::Init, GraphStateDefinition::Running);
+    fsm.declare_transition(GraphStateDefinition::Running, GraphStateDefinition::Done);
+    fsm.set_initial_state(GraphStateDefinition::Init);
+
+    auto analysis = fsm.analyze();
+
+    EXPECT_THAT(analysis.unreachable_states, testing::ElementsAre(app::utils::StateId(GraphStateDefinition::Orphan)));
+    EXPECT_THAT(analysis.sinks_without_exit, testing::ElementsAre(app::utils::StateId(GraphStateDefinition::Done)));
+    EXPECT_TRUE(analysis.dead_overrides.empty());
+    EXPECT_TRUE(analysis.override_cycles.empty());
+}
+
+/** @utdef{UT-FSM-0150 | The analysis must follow the transition overrides and report the overrides that never fire}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0140, DNFW-SRS-FSM-0150
+
+    - GIVEN an fsm with declared transitions Init -> Running -> Done, and Inserted -> Done
+    -   AND an override <Init, Running> -> Inserted
+    -   AND an override <Done, Init> -> Running that does not match any declared transition
+    - WHEN the fsm is analyzed
+    - THEN the Inserted state is reachable, the Running state is unreachable and the <Done, Init> override is reported as dead
+
+ @endut */
+TEST(fsm, analyze_follows_overrides_and_reports_dead_overrides)
+{
+    Fsm fsm;
+
+    fsm.register_state(GraphStateDefinition::Init, nullptr, [](){}, [](){});
+    fsm.register_state(GraphStateDefinition::Running, nullptr, [](){}, [](){});
+    fsm.register_state(GraphStateDefinition::Inserted, nullptr, [](){}, [](){});
+    fsm.register_state(GraphStateDefinition::Done, nullptr, [](){}, [](){});
+
+    fsm.declare_transition(GraphStateDefinition::Init, GraphStateDefinition::Running);
+    fsm.declare_transition(GraphStateDefinition::Running, GraphStateDefinition::Done);
+    fsm.declare_transition(GraphStateDefinition::Inserted, GraphStateDefinition::Done);
+    fsm.transition_override(GraphStateDefinition::Init, GraphStateDefinition::Running, GraphStateDefinition::Inserted);
+    fsm.transition_override(GraphStateDefinition::Done, GraphStateDefinition::Init, GraphStateDefinition::Running);
+    fsm.set_initial_state(GraphStateDefinition::Init);
+
+    auto analysis = fsm.analyze();
+
+    EXPECT_THAT(analysis.unreachable_states, testing::ElementsAre(app::utils::StateId(GraphStateDefinition::Running)));
+    EXPECT_THAT(analysis.dead_overrides, testing::ElementsAre(std::make_pair(app::utils::StateId(GraphStateDefinition::Done), app::utils::StateId(GraphStateDefinition::Init))));
+    EXPECT_TRUE(analysis.sinks_without_exit.empty());
+}
+
+/** @utdef{UT-FSM-0160 | The analysis must report the cycles made of transition overrides}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0150
+
+    - GIVEN an fsm with the overrides <Init, Done> -> Inserted and <Inserted, Done> -> Init
+    - WHEN the fsm is analyzed
+    - THEN the cycle Init -> Inserted -> Init is reported
+
+ @endut */
+TEST(fsm, analyze_reports_override_cycles)
+{
+    Fsm fsm;
+
+    fsm.register_state(GraphStateDefinition::Init, nullptr, [](){}, [](){});
+    fsm.register_state(GraphStateDefinition::Inserted, nullptr, [](){}, [](){});
+    fsm.register_state(GraphStateDefinition::Done, nullptr, [](){}, [](){});
+
+    fsm.declare_transition(GraphStateDefinition::Init, GraphStateDefinition::Done);
+    fsm.declare_transition(GraphStateDefinition::Inserted, GraphStateDefinition::Done);
+    fsm.transition_override(GraphStateDefinition::Init, GraphStateDefinition::Done, GraphStateDefinition::Inserted);
+    fsm.transition_override(GraphStateDefinition::Inserted, GraphStateDefinition::Done, GraphStateDefinition::Init);
+    fsm.set_initial_state(GraphStateDefinition::Init);
+
+    auto analysis = fsm.analyze();
+
+    ASSERT_EQ(analysis.override_cycles.size(), 1u);
+    EXPECT_THAT(analysis.override_cycles[0], testing::UnorderedElementsAre(
+        app::utils::StateId(GraphStateDefinition::Init), 
+        app::utils::StateId(GraphStateDefinition::Inserted)));
+}
+
+/** @utdef{UT-FSM-0170 | Pruning the fsm must drop the unreachable state handlers}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0160
+
+    - GIVEN an fsm with declared transitions Init -> Done, Done declared final, and a registered Orphan state never targeted
+    - WHEN the unreachable states are pruned
+    - THEN the Orphan state handler is not registered anymore, and the reachable state handlers are kept
+
+ @endut */
+TEST(fsm, prune_drops_unreachable_states)
+{
+    Fsm fsm;
+
+    fsm.register_state(GraphStateDefinition::Init, nullptr, [](){}, [](){});
+    fsm.register_state(GraphStateDefinition::Done, nullptr, [](){}, [](){});
+    fsm.register_state(GraphStateDefinition::Orphan, nullptr, [](){}, [](){});
+
+    fsm.declare_transition(GraphStateDefinition::Init, GraphStateDefinition::Done);
+    fsm.declare_final_state(GraphStateDefinition::Done);
+    fsm.set_initial_state(GraphStateDefinition::Init);
+
+    EXPECT_EQ(fsm.prune_unreachable_states(), 1u);
+
+    EXPECT_FALSE(fsm.find_state(GraphStateDefinition::Orphan).has_value());
+    EXPECT_TRUE(fsm.find_state(GraphStateDefinition::Init).has_value());
+    EXPECT_TRUE(fsm.find_state(GraphStateDefinition::Done).has_value());
+}
+
+/** @utdef{UT-FSM-0180 | Registering a new state in a sealed fsm must throw an exception}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0170
+
+    - GIVEN a sealed fsm with a registered state1
+    - WHEN a new state2 is registered, a transition is declared or a transition is overriden
+    - THEN an exception is thrown
+    -  AND overriding the state1 handler does not throw an exception
+
+ @endut */
+TEST(fsm, sealed_fsm_rejects_structural_changes)
+{
+    Fsm fsm;
+
+    fsm.register_state(StateDefinition::State1, nullptr, [](){}, nullptr);
+    fsm.seal();
+
+    EXPECT_TRUE(fsm.is_sealed());
+    EXPECT_THROW(fsm.register_state(StateDefinition::State2, nullptr, [](){}, nullptr), std::runtime_error);
+    EXPECT_THROW(fsm.declare_transition(StateDefinition::State1, StateDefinition::State2), std::runtime_error);
+    EXPECT_THROW(fsm.transition_override(StateDefinition::State1, StateDefinition::State2, StateDefinition::State1), std::runtime_error);
+    EXPECT_NO_THROW(fsm.register_state(StateDefinition::State1, nullptr, [](){}, nullptr));
+}
+
+/** @utdef{UT-FSM-0190 | Taking a transition while the transition counters are enabled must count it}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0180
+
+    - GIVEN an fsm with a state1 that transitions to state2, and the transition counters enabled
+    - WHEN the fsm is started and updated
+    - THEN the counters of the transition state1 -> state2 report one transition
+    -  AND no counters are reported for the transition state2 -> state1
+
+ @endut */
+TEST(fsm, transition_stats_count_taken_transitions)
+{
+    Fsm fsm;
+
+    fsm.register_state(StateDefinition::State1, nullptr, [&fsm](){fsm.transition_to(StateDefinition::State2);}, nullptr);
+    fsm.register_state(StateDefinition::State2, nullptr, [](){}, nullptr);
+    fsm.set_initial_state(StateDefinition::State1);
+    fsm.enable_transition_stats();
+
+    fsm.start();
+    fsm.update();
+
+    auto stats = fsm.find_transition_stats(StateDefinition::State1, StateDefinition::State2);
+    ASSERT_TRUE(stats.has_value());
+    EXPECT_EQ(stats->count, 1u);
+    EXPECT_FALSE(fsm.find_transition_stats(StateDefinition::State2, StateDefinition::State1).has_value());
+}
+
+/** @utdef{UT-FSM-0200 | Exporting the fsm graph must list the states and the declared, overridden and taken transitions}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0190
+
+    - GIVEN an fsm with a declared transition Init -> Running, a transition override <Init, Running> -> Inserted,
+    -   AND the transition counters enabled and the transition Init -> Inserted taken once
+    - WHEN the graph is exported in PlantUML and DOT formats
+    - THEN both diagrams contain the states, labeled with their names, and the transition Init -> Inserted annotated with its counter
+
+ @endut */
+TEST(fsm, export_graph_contains_states_and_annotated_transitions)
+{
+    Fsm fsm;
+    using app::utils::StateId;
+
+    fsm.register_state(GraphStateDefinition::Init, nullptr, [&fsm](){fsm.transition_to(GraphStateDefinition::Running);}, nullptr);
+    fsm.register_state(GraphStateDefinition::Running, nullptr, [](){}, nullptr);
+    fsm.register_state(GraphStateDefinition::Inserted, nullptr, [](){}, nullptr);
+    fsm.declare_transition(GraphStateDefinition::Init, GraphStateDefinition::Running);
+    fsm.transition_override(GraphStateDefinition::Init, GraphStateDefinition::Running, GraphStateDefinition::Inserted);
+    fsm.set_initial_state(GraphStateDefinition::Init);
+    fsm.enable_transition_stats();
+
+    fsm.start();
+    fsm.update();
+
+    auto node = [](GraphStateDefinition state) { return "state_" + std::to_string(static_cast<unsigned int>(StateId(state).value())); };
+
+    auto plantuml = fsm.export_graph(Fsm::GraphFormat::PlantUml);
+    EXPECT_THAT(plantuml, testing::StartsWith("@startuml"));
+    EXPECT_THAT(plantuml, testing::HasSubstr("[*] --> " + node(GraphStateDefinition::Init)));
+    EXPECT_THAT(plantuml, testing::HasSubstr("state \"Running\" as " + node(GraphStateDefinition::Running)));
+    EXPECT_THAT(plantuml, testing::HasSubstr(node(GraphStateDefinition::Init) + " --> " + node(GraphStateDefinition::Inserted) + " : 1x"));
+
+    auto dot = fsm.export_graph(Fsm::GraphFormat::Dot);
+    EXPECT_THAT(dot, testing::StartsWith("digraph fsm {"));
+    EXPECT_THAT(dot, testing::HasSubstr(node(GraphStateDefinition::Inserted) + " [label=\"Inserted\"]"));
+    EXPECT_THAT(dot, testing::HasSubstr(node(GraphStateDefinition::Init) + " -> " + node(GraphStateDefinition::Inserted) + " [label=\"1x"));
+}
+
+/** @utdef{UT-FSM-0210 | Updating a fsm must take the first guarded transition whose guard is true}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0200
+
+    - GIVEN an fsm in state1, with guarded transitions state1 -> state2 and state1 -> state1 declared in this order
+    - WHEN the fsm is updated while both guards are false
+    - THEN the fsm stays in state1
+    - WHEN the fsm is updated while both guards are true
+    - THEN the fsm transitions to state2, after the do function of state1
+
+ @endut */
+TEST(fsm, update_takes_first_guarded_transition)
+{
+    Fsm fsm;
+    MockState mockState;
+    bool enabled = false;
+
+    fsm.register_state(StateDefinition::State1, nullptr, [&mockState](){mockState.state1_on_do();}, [&mockState](){mockState.state1_on_exit();});
+    fsm.register_state(StateDefinition::State2, [&mockState](){mockState.state2_on_enter();}, [](){}, nullptr);
+    fsm.declare_transition(StateDefinition::State1, StateDefinition::State2, [&enabled](){return enabled;});
+    fsm.declare_transition(StateDefinition::State1, StateDefinition::State1, [&enabled](){return enabled;});
+    fsm.set_initial_state(StateDefinition::State1);
+
+    testing::InSequence seq;
+    EXPECT_CALL(mockState, state1_on_do()).Times(2);
+    EXPECT_CALL(mockState, state1_on_exit()).Times(1);
+    EXPECT_CALL(mockState, state2_on_enter()).Times(1);
+
+    fsm.start();
+    fsm.update();
+    EXPECT_TRUE(fsm.is_in_state(StateDefinition::State1));
+
+    enabled = true;
+    fsm.update();
+    EXPECT_TRUE(fsm.is_in_state(StateDefinition::State2));
+}
+
+/** @utdef{UT-FSM-0220 | The guarded transitions must not be evaluated when the do function already initiated a transition}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0200
+
+    - GIVEN an fsm in state1, whose do function transitions to state2, with a guarded transition state1 -> state1
+    - WHEN the fsm is updated
+    - THEN the guard is not evaluated and the fsm is in state2
+
+ @endut */
+TEST(fsm, guards_are_skipped_when_do_function_transitions)
+{
+    Fsm fsm;
+    int evaluations = 0;
+
+    fsm.register_state(StateDefinition::State1, nullptr, [&fsm](){fsm.transition_to(StateDefinition::State2);}, nullptr);
+    fsm.register_state(StateDefinition::State2, nullptr, [](){}, nullptr);
+    fsm.declare_transition(StateDefinition::State1, StateDefinition::State1, [&evaluations](){++evaluations; return true;});
+    fsm.set_initial_state(StateDefinition::State1);
+
+    fsm.start();
+    fsm.update();
+
+    EXPECT_EQ(evaluations, 0);
+    EXPECT_TRUE(fsm.is_in_state(StateDefinition::State2));
+}
+
+/** @utdef{UT-FSM-0230 | Overriding the handler of the current state must switch the fsm to the new handler on the next update}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0130, DNFW-SRS-FSM-0230
+
+    - GIVEN a started fsm in state1, and a state handler of state1 held by the caller
+    - WHEN the handler of state1 is overridden and the fsm is updated
+    - THEN the do function of the new handler is called, without calling the exit and enter functions
+    -  AND the handler held by the caller is still the previous one
+    -  AND the version of the state handlers table has been incremented
+
+ @endut */
+TEST(fsm, state_handler_override_while_running)
+{
+    Fsm fsm;
+    MockState mockState;
+
+    fsm.register_state(StateDefinition::State1, 
+        [&mockState](){mockState.state1_on_enter();},
+        [&mockState](){mockState.state1_on_do();},
+        [&mockState](){mockState.state1_on_exit();}
+    );
+    fsm.set_initial_state(StateDefinition::State1);
+
+    EXPECT_CALL(mockState, state1_on_enter()).Times(1);
+    EXPECT_CALL(mockState, state1_on_do()).Times(1);
+    EXPECT_CALL(mockState, state1_on_exit()).Times(0);
+    EXPECT_CALL(mockState, state2_on_enter()).Times(0);
+    EXPECT_CALL(mockState, state2_on_do()).Times(1);
+
+    fsm.start();
+    fsm.update();
+
+    auto previous = fsm.find_state(StateDefinition::State1);
+    auto version = fsm.state_handlers_version();
+
+    fsm.register_state(StateDefinition::State1, 
+        [&mockState](){mockState.state2_on_enter();},
+        [&mockState](){mockState.state2_on_do();},
+        nullptr
+    );
+    fsm.update();
+
+    ASSERT_TRUE(previous.has_value());
+    EXPECT_TRUE((*previous)->on_exit != nullptr);
+    EXPECT_GT(fsm.state_handlers_version(), version);
+}
+
+/** @utdef{UT-FSM-0240 | Overriding state handlers from another thread must not disturb the fsm updates}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0230
+
+    - GIVEN a started fsm in state1, updated in a loop by the test thread
+    - WHEN another thread overrides the handler of state1 many times, each new handler counting its calls
+    - THEN every update calls exactly one handler, and the last published handler is eventually called
+
+ @endut */
+TEST(fsm, state_handler_override_from_another_thread)
+{
+    Fsm fsm;
+    constexpr int overrides = 1000;
+    std::atomic<int> calls{0};
+    std::atomic<int> last_called{-1};
+
+    fsm.register_state(StateDefinition::State1, nullptr, [&calls](){++calls;}, nullptr);
+    fsm.set_initial_state(StateDefinition::State1);
+    fsm.start();
+
+    std::atomic<bool> done{false};
+    std::thread writer([&]()
+    {
+        for (int i = 0; i < overrides; ++i)
+            fsm.register_state(StateDefinition::State1, nullptr, [&calls, &last_called, i](){++calls; last_called = i;}, nullptr);
+        done = true;
+    });
+
+    int updates = 0;
+    while (!done)
+    {
+        fsm.update();
+        ++updates;
+    }
+    writer.join();
+
+    fsm.update();
+    ++updates;
+
+    EXPECT_EQ(calls, updates);
+    EXPECT_EQ(last_called, overrides - 1);
+}
+
+enum struct LazyStateDefinition
+{
+    State1,
+    State2,
+    State3,
+    State4
+};
+
+/** @utdef{UT-FSM-0250 | A lazy state must be built on its first entry only}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0400
+
+    - GIVEN a fsm with 3 lazy states, each factory counting its calls
+    - WHEN the fsm is started in state1, then transitions to state2 and back to state1
+    - THEN only the factories of state1 and state2 are called, once each, and the state functions of the built handlers are called
+
+ @endut */
+TEST(fsm, lazy_state_is_built_on_first_entry)
+{
+    Fsm fsm;
+    std::array<int, 3> builds{};
+    std::vector<std::string> calls;
+
+    for (auto [state_id, index] : {std::pair{LazyStateDefinition::State1, 0}, {LazyStateDefinition::State2, 1}, {LazyStateDefinition::State3, 2}})
+    {
+        fsm.register_state_factory(state_id, [&builds, &calls, index = index]()
+        {
+            builds[index]++;
+            return Fsm::State([&calls, index](){calls.push_back("enter " + std::to_string(index));}, [](){}, nullptr);
+        });
+    }
+
+    fsm.set_initial_state(LazyStateDefinition::State1);
+    fsm.start();
+    fsm.transition_to(LazyStateDefinition::State2);
+    fsm.transition_to(LazyStateDefinition::State1);
+
+    EXPECT_THAT(builds, ::testing::ElementsAre(1, 1, 0));
+    EXPECT_THAT(calls, ::testing::ElementsAre("enter 0", "enter 1", "enter 0"));
+    EXPECT_EQ(fsm.lazy_states_count(), 2u);
+}
+
+/** @utdef{UT-FSM-0260 | The lazy state cache must evict the least recently entered lazy states}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0410
+
+    - GIVEN a fsm with 3 lazy states and a lazy state cache capacity of 2
+    - WHEN the fsm is started in state1, then transitions to state2, state3 and state1
+    - THEN state1 is evicted when state3 is entered, and rebuilt when entered again, while at most 2 lazy states are built
+
+ @endut */
+TEST(fsm, lazy_state_cache_evicts_least_recently_entered_states)
+{
+    Fsm fsm;
+    std::array<int, 3> builds{};
+
+    for (auto [state_id, index] : {std::pair{LazyStateDefinition::State1, 0}, {LazyStateDefinition::State2, 1}, {LazyStateDefinition::State3, 2}})
+        fsm.register_state_factory(state_id, [&builds, index = index]() { builds[index]++; return Fsm::State(nullptr, [](){}, nullptr); });
+
+    fsm.set_lazy_state_cache_capacity(2);
+    fsm.set_initial_state(LazyStateDefinition::State1);
+    fsm.start();
+    fsm.transition_to(LazyStateDefinition::State2);
+    fsm.transition_to(LazyStateDefinition::State3);
+    EXPECT_EQ(fsm.lazy_states_count(), 2u);
+
+    fsm.transition_to(LazyStateDefinition::State1);
+
+    EXPECT_THAT(builds, ::testing::ElementsAre(2, 1, 1));
+    EXPECT_EQ(fsm.lazy_states_count(), 2u);
+    EXPECT_TRUE(fsm.update());
+}
+
+/** @utdef{UT-FSM-0270 | Finding a lazy state must build it}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0400
+
+    - GIVEN a fsm with a lazy state1
+    - WHEN state1 is found twice
+    - THEN the same built handler is returned, and the factory is called once
+
+ @endut */
+TEST(fsm, finding_lazy_state_builds_it)
+{
+    Fsm fsm;
+    int builds = 0;
+    fsm.register_state_factory(LazyStateDefinition::State1, [&builds]() { builds++; return Fsm::State(nullptr, [](){}, nullptr); });
+
+    auto first = fsm.find_state(LazyStateDefinition::State1);
+    auto second = fsm.find_state(LazyStateDefinition::State1);
+
+    ASSERT_TRUE(first.has_value());
+    ASSERT_TRUE(second.has_value());
+    EXPECT_EQ(first.value(), second.value());
+    EXPECT_EQ(builds, 1);
+    EXPECT_FALSE(fsm.find_state(LazyStateDefinition::State2).has_value());
+}
+
+/** @utdef{UT-FSM-0280 | Overriding a lazy state must make it a regular state}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0420
+
+    - GIVEN a sealed fsm with lazy states state1 and state2, and a lazy state cache capacity of 1
+    - WHEN the handler of state2 is overridden by a registered handler calling the original one (found with find_state), and the fsm
+      transitions from state1 to state2 and back to state1
+    - THEN the override is called and is never evicted, and the factory of state2 is called once
+
+ @endut */
+TEST(fsm, overriding_lazy_state_makes_it_regular)
+{
+    Fsm fsm;
+    int builds = 0;
+    std::vector<std::string> calls;
+
+    fsm.register_state_factory(LazyStateDefinition::State1, []() { return Fsm::State(nullptr, [](){}, nullptr); });
+    fsm.register_state_factory(LazyStateDefinition::State2, [&builds, &calls]() { builds++; return Fsm::State([&calls](){calls.push_back("original enter");}, [](){}, nullptr); });
+    fsm.set_lazy_state_cache_capacity(1);
+    fsm.seal();
+
+    auto original = fsm.find_state(LazyStateDefinition::State2).value();
+    fsm.register_state(LazyStateDefinition::State2, [&calls, original](){calls.push_back("override enter"); original->on_enter();}, [](){}, nullptr);
+
+    fsm.set_initial_state(LazyStateDefinition::State1);
+    fsm.start();
+    fsm.transition_to(LazyStateDefinition::State2);
+    fsm.transition_to(LazyStateDefinition::State1);
+    fsm.transition_to(LazyStateDefinition::State2);
+
+    EXPECT_THAT(calls, ::testing::ElementsAre("override enter", "original enter", "override enter", "original enter"));
+    EXPECT_EQ(builds, 1);
+    EXPECT_THROW(fsm.register_state_factory(LazyStateDefinition::State3, []() { return Fsm::State(); }), std::runtime_error);
+}
+
+/** @utdef{UT-FSM-0290 | The state identifier must give the name of its enumerator}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0430
+
+    - GIVEN state identifiers of enum types registered in a fsm, of an enum type not registered yet, on a value which is not an
+            enumerator, and a default state identifier
+    - WHEN their names are requested
+    - THEN the names of the enumerators of the registered types are returned, the other names are empty until the type is registered,
+    -  AND the state identifier holds its value only
+
+ @endut */
+TEST(fsm, state_id_gives_enumerator_name)
+{
+    enum struct UnregisteredState
+    {
+        Alone
+    };
+
+    Fsm fsm;
+    fsm.register_state(StateDefinition::State1, nullptr, [](){}, nullptr);
+    fsm.register_state_factory(LazyStateDefinition::State3, []() { return Fsm::State(); });
+
+    EXPECT_EQ(app::utils::StateId(StateDefinition::State1).name(), "State1");
+    EXPECT_EQ(app::utils::StateId(StateDefinition::State2).name(), "State2");
+    EXPECT_EQ(app::utils::StateId(LazyStateDefinition::State3).name(), "State3");
+    EXPECT_EQ(app::utils::StateId(static_cast<StateDefinition>(42)).name(), "");
+    EXPECT_EQ(app::utils::StateId().name(), "");
+
+    EXPECT_EQ(app::utils::StateId(UnregisteredState::Alone).name(), "");
+    app::utils::StateId::register_names<UnregisteredState>();
+    EXPECT_EQ(app::utils::StateId(UnregisteredState::Alone).name(), "Alone");
+
+    static_assert(enumValueName<StateDefinition::State2>() == "State2");
+    static_assert(sizeof(app::utils::StateId) == sizeof(int));
+}
+
+/** @utdef{UT-FSM-0300 | The exceptions must name the state}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0430
+
+    - GIVEN a started fsm in state1, which has no do function
+    - WHEN the fsm is updated, or transitions to the unregistered state2
+    - THEN the messages of the thrown exceptions contain the names of the states
+
+ @endut */
+TEST(fsm, exceptions_name_the_state)
+{
+    Fsm fsm;
+    fsm.register_state(StateDefinition::State1, nullptr, nullptr, nullptr);
+    fsm.set_initial_state(StateDefinition::State1);
+    fsm.start();
+
+    try
+    {
+        fsm.update();
+        FAIL() << "No exception thrown";
+    }
+    catch (const std::runtime_error& error)
+    {
+        EXPECT_THAT(error.what(), testing::HasSubstr("State1"));
+    }
+
+    try
+    {
+        fsm.transition_to(StateDefinition::State2);
+        FAIL() << "No exception thrown";
+    }
+    catch (const std::runtime_error& error)
+    {
+        EXPECT_THAT(error.what(), testing::HasSubstr("State2"));
+    }
+}
+
+/** @utdef{UT-FSM-0310 | Updating a started fsm must not allocate}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0440
+
+    - GIVEN a started fsm in state1, with a guarded transition to state2 whose guard is false
+    - WHEN the fsm is updated 100 times
+    - THEN no allocation is done
+
+ @endut */
+TEST(fsm, update_does_not_allocate)
+{
+    Fsm fsm;
+    int updates = 0;
+    fsm.register_state(StateDefinition::State1, nullptr, [&updates](){updates++;}, nullptr);
+    fsm.register_state(StateDefinition::State2, nullptr, [](){}, nullptr);
+    fsm.declare_transition(StateDefinition::State1, StateDefinition::State2, [&updates](){ return updates < 0; });
+    fsm.set_initial_state(StateDefinition::State1);
+    fsm.start();
+
+    UT_EXPECT_NO_ALLOCATION(for (int i = 0; i < 100; ++i) fsm.update());
+    EXPECT_EQ(updates, 100);
+}
+
+/** @utdef{UT-FSM-0320 | Transitions between registered states must not allocate}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0440
+
+    - GIVEN a started fsm with state1 and state2, with the transition counters enabled and each transition taken once
+    - WHEN the fsm transitions 100 times between state1 and state2
+    - THEN no allocation is done
+
+ @endut */
+TEST(fsm, transitions_do_not_allocate)
+{
+    Fsm fsm;
+    fsm.register_state(StateDefinition::State1, [](){}, [](){}, [](){});
+    fsm.register_state(StateDefinition::State2, [](){}, [](){}, [](){});
+    fsm.set_initial_state(StateDefinition::State1);
+    fsm.enable_transition_stats();
+    fsm.start();
+
+    // The counters of a transition are allocated the first time it is taken
+    fsm.transition_to(StateDefinition::State2);
+    fsm.transition_to(StateDefinition::State1);
+
+    UT_EXPECT_NO_ALLOCATION(for (int i = 0; i < 100; ++i) fsm.transition_to(i % 2 ? StateDefinition::State1 : StateDefinition::State2));
+    EXPECT_EQ(fsm.find_transition_stats(StateDefinition::State1, StateDefinition::State2).value().count, 51u);
+    EXPECT_EQ(fsm.find_transition_stats(StateDefinition::State2, StateDefinition::State1).value().count, 51u);
+}
+
+/** @utdef{UT-FSM-0330 | The update and the transitions of a fsm must stay under their latency ceilings}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0440
+
+    - GIVEN a started fsm with state1 and state2, with empty state functions
+    - WHEN the fsm is updated, and transitions from state1 to state2 and back, 1001 times each
+    - THEN the median duration of an update is at most 5000 ticks, and the median duration of a round trip is at most 20000 ticks
+      (ceilings with a margin for the non optimized builds, to detect the regressions by an order of magnitude)
+
+ @endut */
+TEST(fsm, update_and_transitions_stay_under_latency_ceilings)
+{
+    Fsm fsm;
+    fsm.register_state(StateDefinition::State1, [](){}, [](){}, [](){});
+    fsm.register_state(StateDefinition::State2, [](){}, [](){}, [](){});
+    fsm.set_initial_state(StateDefinition::State1);
+    fsm.start();
+
+    UT_EXPECT_MEDIAN_TICKS_LE(fsm.update(), 5000);
+    UT_EXPECT_MEDIAN_TICKS_LE(fsm.transition_to(StateDefinition::State2); fsm.transition_to(StateDefinition::State1), 20000);
+}
+
+/** @utdef{UT-FSM-0340 | Pruning a started fsm must keep the initial state handler}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0160
+
+    - GIVEN a started fsm with declared transitions Init -> Done only, Done declared final, which transitioned to Done
+    - WHEN the unreachable states are pruned
+    - THEN the Init state handler is kept, as the fsm may be restarted from it, and the fsm can be restarted
+
+ @endut */
+TEST(fsm, prune_keeps_initial_state_of_started_fsm)
+{
+    Fsm fsm;
+
+    fsm.register_state(GraphStateDefinition::Init, nullptr, [](){}, [](){});
+    fsm.register_state(GraphStateDefinition::Done, nullptr, [](){}, [](){});
+
+    fsm.declare_transition(GraphStateDefinition::Init, GraphStateDefinition::Done);
+    fsm.declare_final_state(GraphStateDefinition::Done);
+    fsm.set_initial_state(GraphStateDefinition::Init);
+    fsm.start();
+    fsm.transition_to(GraphStateDefinition::Done);
+
+    EXPECT_EQ(fsm.prune_unreachable_states(), 0u);
+
+    EXPECT_TRUE(fsm.find_state(GraphStateDefinition::Init).has_value());
+    EXPECT_TRUE(fsm.find_state(GraphStateDefinition::Done).has_value());
+
+    fsm.exit();
+    fsm.set_initial_state(GraphStateDefinition::Init);
+    EXPECT_NO_THROW(fsm.start());
+}
+
+enum struct ManyStatesDefinition
+{
+    First
+};
+
+/** @utdef{UT-FSM-0350 | Registering the states of a large fsm must not copy the state handlers table}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0510, DNFW-SRS-FSM-0230
+
+    - GIVEN a fsm which is not started
+    - WHEN 16384 states are registered
+    - THEN at most 4 allocations per state are done (the state handler, the table node, and the amortized table growth)
+    -  AND once the fsm is started, overriding a state handler publishes a new table, while the handlers already fetched are kept
+
+ @endut */
+TEST(fsm, registering_many_states_does_not_copy_the_table)
+{
+    constexpr int states = 16384;
+    Fsm fsm;
+
+    auto register_states = [&fsm]()
+    {
+        for (int i = 0; i < states; ++i)
+            fsm.register_state(static_cast<ManyStatesDefinition>(i), nullptr, [](){}, nullptr);
+    };
+
+    UT_EXPECT_ALLOCATIONS_LE(register_states(), 4 * states);
+
+    fsm.set_initial_state(ManyStatesDefinition::First);
+    fsm.start();
+
+    auto first = fsm.find_state(ManyStatesDefinition::First).value();
+    auto version = fsm.state_handlers_version();
+    fsm.register_state(ManyStatesDefinition::First, nullptr, [](){}, nullptr);
+
+    EXPECT_GT(fsm.state_handlers_version(), version);
+    EXPECT_NE(fsm.find_state(ManyStatesDefinition::First).value(), first);
+    EXPECT_TRUE(fsm.find_state(static_cast<ManyStatesDefinition>(states - 1)).has_value());
+    EXPECT_TRUE(fsm.update());
+}
+
+/** @utdef{UT-FSM-0360 | The lazy state cache must not publish a new table when no state is evicted}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0410
+
+    - GIVEN a fsm started in the lazy state1, with a lazy state cache capacity of 1
+    - WHEN the lazy state2 is built by find_state, then the cache capacity is set again to 1
+      (the cache is beyond its capacity, but neither the current state nor the most recently built state can be evicted)
+    - THEN the version of the state handlers table is only incremented once, by the publication of state2, and both lazy states are still built
+
+ @endut */
+TEST(fsm, lazy_state_cache_does_not_publish_without_eviction)
+{
+    Fsm fsm;
+    fsm.register_state_factory(LazyStateDefinition::State1, []() { return Fsm::State(nullptr, [](){}, nullptr); });
+    fsm.register_state_factory(LazyStateDefinition::State2, []() { return Fsm::State(nullptr, [](){}, nullptr); });
+    fsm.set_lazy_state_cache_capacity(1);
+    fsm.set_initial_state(LazyStateDefinition::State1);
+    fsm.start();
+
+    auto version = fsm.state_handlers_version();
+    ASSERT_TRUE(fsm.find_state(LazyStateDefinition::State2).has_value());
+    fsm.set_lazy_state_cache_capacity(1);
+
+    EXPECT_EQ(fsm.state_handlers_version(), version + 1);
+    EXPECT_EQ(fsm.lazy_states_count(), 2u);
+}
+
+/** @utdef{UT-FSM-0370 | Pruning the fsm must require the declared transitions of the reachable states}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0160
+
+    - GIVEN an fsm with declared transitions Init -> Done, Done registered without declared transition, and a registered Orphan state
+    - WHEN the unreachable states are pruned, then Done is declared final and the states are pruned twice
+    - THEN the first prune throws and drops nothing, the second one drops Orphan,
+    -  AND the third one drops nothing without publishing a new state handlers table
+
+ @endut */
+TEST(fsm, prune_requires_declared_transitions_of_reachable_states)
+{
+    Fsm fsm;
+
+    fsm.register_state(GraphStateDefinition::Init, nullptr, [](){}, [](){});
+    fsm.register_state(GraphStateDefinition::Done, nullptr, [](){}, [](){});
+    fsm.register_state(GraphStateDefinition::Orphan, nullptr, [](){}, [](){});
+
+    fsm.declare_transition(GraphStateDefinition::Init, GraphStateDefinition::Done);
+    fsm.set_initial_state(GraphStateDefinition::Init);
+
+    EXPECT_THROW(fsm.prune_unreachable_states(), std::runtime_error);
+    EXPECT_TRUE(fsm.find_state(GraphStateDefinition::Orphan).has_value());
+
+    fsm.declare_final_state(GraphStateDefinition::Done);
+    EXPECT_EQ(fsm.prune_unreachable_states(), 1u);
+    EXPECT_FALSE(fsm.find_state(GraphStateDefinition::Orphan).has_value());
+
+    auto version = fsm.state_handlers_version();
+    EXPECT_EQ(fsm.prune_unreachable_states(), 0u);
+    EXPECT_EQ(fsm.state_handlers_version(), version);
+}
+
+/** @utdef{UT-FSM-0380 | The analysis must not depend on the lazy states built}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0150
+
+    - GIVEN an fsm with declared transitions State1 -> State2 and State1 -> State3 between lazy states, State2 registered without exit function
+    -   AND a lazy state cache capacity of 1
+    - WHEN the fsm is analyzed before State2 is built, while it is built, and after it is evicted
+    - THEN the three analyses report State2 as the only sink without exit function
+
+ @endut */
+TEST(fsm, analyze_does_not_depend_on_built_lazy_states)
+{
+    Fsm fsm;
+
+    fsm.register_state_factory(LazyStateDefinition::State1, []() { return Fsm::State(nullptr, [](){}, [](){}); });
+    fsm.register_state_factory(LazyStateDefinition::State2, []() { return Fsm::State(nullptr, [](){}, nullptr); }, false);
+    fsm.register_state_factory(LazyStateDefinition::State3, []() { return Fsm::State(nullptr, [](){}, [](){}); });
+    fsm.set_lazy_state_cache_capacity(1);
+
+    fsm.declare_transition(LazyStateDefinition::State1, LazyStateDefinition::State2);
+    fsm.declare_transition(LazyStateDefinition::State1, LazyStateDefinition::State3);
+    fsm.set_initial_state(LazyStateDefinition::State1);
+    fsm.start();
+
+    auto before_build = fsm.analyze();
+    fsm.transition_to(LazyStateDefinition::State2);
+    auto built = fsm.analyze();
+    fsm.transition_to(LazyStateDefinition::State3);
+    fsm.transition_to(LazyStateDefinition::State1);
+    auto evicted = fsm.analyze();
+
+    for (const auto* analysis : {&before_build, &built, &evicted})
+    {
+        EXPECT_THAT(analysis->sinks_without_exit, testing::ElementsAre(app::utils::StateId(LazyStateDefinition::State2)));
+        EXPECT_TRUE(analysis->unreachable_states.empty());
+    }
+}
+
+/** @utdef{UT-FSM-0390 | A state handler swapped while its do function runs must run until its do function returns and exit the state}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0230
+
+    - GIVEN a started fsm in state1, whose do function waits for another thread overriding the handler of state1, then transitions to state2
+      and reads a value captured by its handler
+    - WHEN the fsm is updated
+    - THEN the do function reads the captured value after the transition, the state1 is exited by the running handler and not by the new
+      one, and the fsm is in state2
+
+ @endut */
+TEST(fsm, state_handler_swapped_while_its_do_function_transitions)
+{
+    Fsm fsm;
+    auto captured = std::make_shared<int>(42);
+    int read = 0;
+    int running_exits = 0;
+    int new_exits = 0;
+
+    fsm.register_state(StateDefinition::State1, nullptr, [&fsm, &read, &new_exits, captured]()
+    {
+        std::thread swapper([&fsm, &new_exits]()
+        {
+            fsm.register_state(StateDefinition::State1, nullptr, [](){}, [&new_exits](){new_exits++;});
+        });
+        swapper.join();
+
+        fsm.transition_to(StateDefinition::State2);
+        read = *captured;
+    }, [&running_exits](){running_exits++;});
+    fsm.register_state(StateDefinition::State2, nullptr, [](){}, nullptr);
+    fsm.set_initial_state(StateDefinition::State1);
+    fsm.start();
+    captured.reset();
+
+    fsm.update();
+
+    EXPECT_EQ(read, 42);
+    EXPECT_EQ(running_exits, 1);
+    EXPECT_EQ(new_exits, 0);
+    EXPECT_TRUE(fsm.is_in_state(StateDefinition::State2));
+}
+
+/** @utdef{UT-FSM-0400 | A lazy state evicted while its do function runs must run until its do function returns}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0410
+
+    - GIVEN a fsm started in the lazy state1, with a lazy state cache capacity of 1
+    -   AND the do function of state1 transitioning to the lazy state2, then reading a value captured by its handler only
+    -   AND the enter functions of the lazy states state2 and state3 transitioning to the lazy state3 and state4
+    - WHEN the fsm is updated (the entry of state4 evicts state1 and state2 while their functions run)
+    - THEN the do function reads the captured value after the transition, and the fsm is in state4, with only state3 (current when
+      state4 was built) and state4 still built
+
+ @endut */
+TEST(fsm, lazy_state_evicted_while_its_do_function_runs)
+{
+    Fsm fsm;
+    int read = 0;
+
+    fsm.register_state_factory(LazyStateDefinition::State1, [&fsm, &read]()
+    {
+        return Fsm::State(nullptr, [&fsm, &read, captured = std::make_shared<int>(42)]()
+        {
+            fsm.transition_to(LazyStateDefinition::State2);
+            read = *captured;
+        }, nullptr);
+    });
+    fsm.register_state_factory(LazyStateDefinition::State2, [&fsm]()
+    {
+        return Fsm::State([&fsm](){ fsm.transition_to(LazyStateDefinition::State3); }, [](){}, nullptr);
+    });
+    fsm.register_state_factory(LazyStateDefinition::State3, [&fsm]()
+    {
+        return Fsm::State([&fsm](){ fsm.transition_to(LazyStateDefinition::State4); }, [](){}, nullptr);
+    });
+    fsm.register_state_factory(LazyStateDefinition::State4, []() { return Fsm::State(nullptr, [](){}, nullptr); });
+
+    fsm.set_lazy_state_cache_capacity(1);
+    fsm.set_initial_state(LazyStateDefinition::State1);
+    fsm.start();
+
+    fsm.update();
+
+    EXPECT_EQ(read, 42);
+    EXPECT_TRUE(fsm.is_in_state(LazyStateDefinition::State4));
+    EXPECT_EQ(fsm.lazy_states_count(), 2u);
+}
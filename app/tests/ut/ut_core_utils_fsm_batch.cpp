@@ -0,0 +1,207 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <utils/Fsm/FsmBatch.h>
+#include <utils/Fsm/FsmRegistry.h>
+
+#include <memory>
+#include <vector>
+
+using app::utils::BatchGuard;
+using app::utils::BatchTransition;
+using app::utils::Fsm;
+using app::utils::FsmBatch;
+
+enum struct BatchStateDefinition
+{
+    Idle,
+    Active,
+    Busy
+};
+
+/** @utdef{UT-FSMBATCH-0010 | Evaluating a guard over a batch must set the bits of the rows for which the guard is true}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0210
+
+    - GIVEN a column of 70 values, where the value of the row *i* is *i*
+    - WHEN the guards *< 3*, *<= 3*, *> 66* and *>= 66* are evaluated over the column
+    - THEN the resulting bitmasks select the matching rows, including the rows of the scalar tail and of the second mask word
+
+ @endut */
+TEST(fsm_batch, evaluate_sets_mask_bits_of_matching_rows)
+{
+    std::vector<float> column(70);
+    for (std::size_t i = 0; i < column.size(); ++i)
+        column[i] = static_cast<float>(i);
+
+    std::uint64_t mask[FsmBatch::mask_size(70)];
+
+    FsmBatch::evaluate({column.data(), BatchGuard::Comparison::Less, 3.0f}, column.size(), mask);
+    EXPECT_EQ(mask[0], 0b111u);
+    EXPECT_EQ(mask[1], 0u);
+
+    FsmBatch::evaluate({column.data(), BatchGuard::Comparison::LessEqual, 3.0f}, column.size(), mask);
+    EXPECT_EQ(mask[0], 0b1111u);
+
+    FsmBatch::evaluate({column.data(), BatchGuard::Comparison::Greater, 66.0f}, column.size(), mask);
+    EXPECT_EQ(mask[0], 0u);
+    EXPECT_EQ(mask[1], 0b111000u);
+
+    FsmBatch::evaluate({column.data(), BatchGuard::Comparison::GreaterEqual, 66.0f}, column.size(), mask);
+    EXPECT_EQ(mask[1], 0b111100u);
+}
+
+/** @utdef{UT-FSMBATCH-0020 | A batch step must apply at most one transition per instance, from the state of the instance before the step}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0210, DNFW-SRS-FSM-0220
+
+    - GIVEN a batch of 100 instances in the Idle state, with a level column where the even instances have a high level
+    -   AND the transitions Idle -> Active when level > 0.5, and Active -> Idle when level > 0.5
+    - WHEN a batch step is applied
+    - THEN the 50 even instances are in the Active state, and the odd instances remain in the Idle state
+
+ @endut */
+TEST(fsm_batch, step_applies_one_transition_per_instance)
+{
+    std::vector<std::unique_ptr<Fsm>> fleet;
+    std::vector<Fsm*> instances;
+    std::vector<float> level;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        auto fsm = std::make_unique<Fsm>();
+        fsm->register_state(BatchStateDefinition::Idle, nullptr, [](){}, nullptr);
+        fsm->register_state(BatchStateDefinition::Active, nullptr, [](){}, nullptr);
+        fsm->set_initial_state(BatchStateDefinition::Idle);
+        fsm->start();
+        instances.push_back(fsm.get());
+        fleet.push_back(std::move(fsm));
+        level.push_back(i % 2 == 0 ? 1.0f : 0.0f);
+    }
+
+    std::vector<BatchTransition> transitions{
+        {BatchStateDefinition::Idle, BatchStateDefinition::Active, {level.data(), BatchGuard::Comparison::Greater, 0.5f}},
+        {BatchStateDefinition::Active, BatchStateDefinition::Idle, {level.data(), BatchGuard::Comparison::Greater, 0.5f}},
+    };
+
+    FsmBatch batch;
+    EXPECT_EQ(batch.step(instances, transitions), 50u);
+
+    for (std::size_t i = 0; i < instances.size(); ++i)
+        EXPECT_EQ(instances[i]->is_in_state(BatchStateDefinition::Active), i % 2 == 0) << "instance " << i;
+}
+
+/** @utdef{UT-FSMBATCH-0030 | A batch step must follow the state handlers and the transition overrides changed after a previous step}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0220, DNFW-SRS-FSM-0500
+
+    - GIVEN a batch of 10 instances which took the transitions Idle -> Active and Active -> Idle in two previous steps
+    -   AND the instance 0 then overrides the transition Idle -> Active toward Busy, and the instance 1 overrides the handler of Active
+    -   AND the transition Idle -> Active is provided twice, with a guard true for the even instances and a guard true for the odd ones
+    - WHEN a batch step is applied
+    - THEN the 10 instances take one transition: the instance 0 enters Busy, the instance 1 enters the new handler of Active,
+           and the other instances enter Active with the handler they entered it with before
+
+ @endut */
+TEST(fsm_batch, step_follows_handlers_and_overrides_changed_after_previous_step)
+{
+    std::vector<std::unique_ptr<Fsm>> fleet;
+    std::vector<Fsm*> instances;
+    std::vector<float> level;
+    std::vector<float> even;
+    std::vector<float> odd;
+    int active_entries = 0;
+
+    for (int i = 0; i < 10; ++i)
+    {
+        auto fsm = std::make_unique<Fsm>();
+        fsm->register_state(BatchStateDefinition::Idle, nullptr, [](){}, nullptr);
+        fsm->register_state(BatchStateDefinition::Active, [&active_entries](){ ++active_entries; }, [](){}, nullptr);
+        fsm->register_state(BatchStateDefinition::Busy, nullptr, [](){}, nullptr);
+        fsm->set_initial_state(BatchStateDefinition::Idle);
+        fsm->start();
+        instances.push_back(fsm.get());
+        fleet.push_back(std::move(fsm));
+        level.push_back(1.0f);
+        even.push_back(i % 2 == 0 ? 1.0f : 0.0f);
+        odd.push_back(i % 2 == 0 ? 0.0f : 1.0f);
+    }
+
+    std::vector<BatchTransition> transitions{
+        {BatchStateDefinition::Idle, BatchStateDefinition::Active, {level.data(), BatchGuard::Comparison::Greater, 0.5f}},
+        {BatchStateDefinition::Active, BatchStateDefinition::Idle, {level.data(), BatchGuard::Comparison::Greater, 0.5f}},
+    };
+
+    FsmBatch batch;
+    ASSERT_EQ(batch.step(instances, transitions), 10u);
+    ASSERT_EQ(batch.step(instances, transitions), 10u);
+    ASSERT_EQ(active_entries, 10);
+
+    int new_active_entries = 0;
+    instances[0]->transition_override(BatchStateDefinition::Idle, BatchStateDefinition::Active, BatchStateDefinition::Busy);
+    instances[1]->register_state(BatchStateDefinition::Active, [&new_active_entries](){ ++new_active_entries; }, [](){}, nullptr);
+
+    std::vector<BatchTransition> split_transitions{
+        {BatchStateDefinition::Idle, BatchStateDefinition::Active, {even.data(), BatchGuard::Comparison::Greater, 0.5f}},
+        {BatchStateDefinition::Idle, BatchStateDefinition::Active, {odd.data(), BatchGuard::Comparison::Greater, 0.5f}},
+    };
+
+    EXPECT_EQ(batch.step(instances, split_transitions), 10u);
+
+    EXPECT_TRUE(instances[0]->is_in_state(BatchStateDefinition::Busy));
+    for (std::size_t i = 1; i < instances.size(); ++i)
+        EXPECT_TRUE(instances[i]->is_in_state(BatchStateDefinition::Active)) << "instance " << i;
+    EXPECT_EQ(new_active_entries, 1);
+    EXPECT_EQ(active_entries, 18);
+}
+
+/** @utdef{UT-FSMBATCH-0040 | A batch step must not take the transitions prepared for a destroyed instance}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0500
+
+    - GIVEN a registry instance which took the transition Idle -> Active in a batch step
+    - WHEN the instance is destroyed, another instance is created in the same registry slot, and the batch steps again
+    - THEN the new instance enters its own Active handler, and the handler of the destroyed instance is not called again
+
+ @endut */
+TEST(fsm_batch, step_does_not_reuse_transitions_of_destroyed_instances)
+{
+    app::utils::FsmRegistry registry;
+    int old_entries = 0;
+    int new_entries = 0;
+
+    auto setup = [](Fsm& fsm, int& entries) {
+        fsm.register_state(BatchStateDefinition::Idle, nullptr, [](){}, nullptr);
+        fsm.register_state(BatchStateDefinition::Active, [&entries](){ ++entries; }, [](){}, nullptr);
+        fsm.set_initial_state(BatchStateDefinition::Idle);
+        fsm.start();
+    };
+
+    auto old_handle = registry.create();
+    Fsm* old_fsm = &registry.at(old_handle);
+    setup(*old_fsm, old_entries);
+
+    std::vector<float> level{1.0f};
+    std::vector<BatchTransition> transitions{
+        {BatchStateDefinition::Idle, BatchStateDefinition::Active, {level.data(), BatchGuard::Comparison::Greater, 0.5f}},
+    };
+
+    FsmBatch batch;
+    std::vector<Fsm*> instances{old_fsm};
+    ASSERT_EQ(batch.step(instances, transitions), 1u);
+    ASSERT_EQ(old_entries, 1);
+
+    registry.destroy(old_handle);
+    auto new_handle = registry.create();
+    Fsm* new_fsm = &registry.at(new_handle);
+    ASSERT_EQ(new_fsm, old_fsm);
+    setup(*new_fsm, new_entries);
+
+    instances = {new_fsm};
+    EXPECT_EQ(batch.step(instances, transitions), 1u);
+    EXPECT_EQ(old_entries, 1);
+    EXPECT_EQ(new_entries, 1);
+}
@@ -0,0 +1,327 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <utils/Fsm/FsmBudgetedDriver.h>
+
+#include <array>
+#include <thread>
+
+using app::utils::Fsm;
+using app::utils::FsmBudgetedDriver;
+using app::utils::Tsc;
+using namespace std::chrono_literals;
+
+namespace
+{
+    enum struct FleetState
+    {
+        Running
+    };
+
+    /* Fleet of started fsm recording the order of their updates, each update lasting the provided duration */
+    struct Fleet
+    {
+        std::array<Fsm, 5> instances;
+        std::vector<int> updates;
+
+        explicit Fleet(std::chrono::milliseconds update_duration = 0ms)
+        {
+            for (int i = 0; i < static_cast<int>(instances.size()); ++i)
+            {
+                instances[i].register_state(FleetState::Running, nullptr, [this, i, update_duration](){
+                    updates.push_back(i);
+                    std::this_thread::sleep_for(update_duration);
+                }, nullptr);
+                instances[i].set_initial_state(FleetState::Running);
+                instances[i].start();
+            }
+        }
+
+        void add_to(FsmBudgetedDriver& driver)
+        {
+            for (auto& fsm : instances)
+                driver.add(fsm);
+        }
+    };
+}
+
+/** @utdef{UT-FSMBUDGET-0010 | The budgeted driver must resume the next tick where the previous tick stopped}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0290, DNFW-SRS-FSM-0300
+
+    - GIVEN a driver with a fleet of 5 fsm
+    - WHEN 2 ticks are run with a budget of 3 updates
+    - THEN the first tick updates the fsm 0, 1 and 2, and the second tick updates the fsm 3, 4 and 0
+
+ @endut */
+TEST(fsm_budget, resumes_where_the_previous_tick_stopped)
+{
+    Fleet fleet;
+    FsmBudgetedDriver driver;
+    fleet.add_to(driver);
+
+    FsmBudgetedDriver::Budget budget;
+    budget.max_updates = 3;
+
+    EXPECT_EQ(driver.tick(budget), 3u);
+    EXPECT_EQ(driver.tick(budget), 3u);
+
+    EXPECT_THAT(fleet.updates, ::testing::ElementsAre(0, 1, 2, 3, 4, 0));
+    EXPECT_EQ(driver.get_stats().ticks, 2u);
+    EXPECT_EQ(driver.get_stats().updates, 6u);
+    EXPECT_EQ(driver.get_stats().exhausted_ticks, 2u);
+}
+
+/** @utdef{UT-FSMBUDGET-0020 | The budgeted driver must update each instance at most once per tick}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0290
+
+    - GIVEN a driver with a fleet of 5 fsm
+    - WHEN a tick is run without budget
+    - THEN each fsm is updated once and the tick is not reported as exhausted
+
+ @endut */
+TEST(fsm_budget, updates_each_instance_once_per_tick)
+{
+    Fleet fleet;
+    FsmBudgetedDriver driver;
+    fleet.add_to(driver);
+
+    EXPECT_EQ(driver.tick({}), 5u);
+
+    EXPECT_THAT(fleet.updates, ::testing::ElementsAre(0, 1, 2, 3, 4));
+    EXPECT_EQ(driver.get_stats().exhausted_ticks, 0u);
+}
+
+/** @utdef{UT-FSMBUDGET-0030 | The budgeted driver must stop a tick when its duration budget is exhausted}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0290, DNFW-SRS-FSM-0310
+
+    - GIVEN a driver with a fleet of 5 fsm, whose updates last 2 ms each
+    - WHEN a tick is run with a duration budget of 1 ms
+    - THEN only the first fsm is updated (at least one update per tick), and the next tick updates the second fsm
+
+ @endut */
+TEST(fsm_budget, stops_a_tick_when_the_duration_budget_is_exhausted)
+{
+    Fleet fleet(2ms);
+    FsmBudgetedDriver driver;
+    fleet.add_to(driver);
+
+    FsmBudgetedDriver::Budget budget;
+    budget.max_duration = 1ms;
+
+    EXPECT_EQ(driver.tick(budget), 1u);
+    EXPECT_EQ(driver.tick(budget), 1u);
+
+    EXPECT_THAT(fleet.updates, ::testing::ElementsAre(0, 1));
+}
+
+/** @utdef{UT-FSMBUDGET-0040 | The budgeted driver must update the woken instances in priority}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0320
+
+    - GIVEN a driver with a fleet of 5 fsm
+    - WHEN the fsm 3 is woken, then a tick is run with a budget of 2 updates
+    - THEN the tick updates the fsm 3, then the fsm 0
+
+ @endut */
+TEST(fsm_budget, updates_woken_instances_in_priority)
+{
+    Fleet fleet;
+    FsmBudgetedDriver driver;
+    fleet.add_to(driver);
+
+    driver.wake(fleet.instances[3]);
+
+    FsmBudgetedDriver::Budget budget;
+    budget.max_updates = 2;
+    driver.tick(budget);
+
+    EXPECT_THAT(fleet.updates, ::testing::ElementsAre(3, 0));
+    EXPECT_EQ(driver.get_stats().overdue_updates, 1u);
+}
+
+/** @utdef{UT-FSMBUDGET-0050 | The budgeted driver must update a starving instance before the woken instances}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0320
+
+    - GIVEN a driver with a fleet of 5 fsm and a starvation limit of 2 ticks
+    - WHEN the fsm 4 is woken before each of 4 ticks run with a budget of 1 update
+    - THEN the fsm 4 is updated by the 3 first ticks, and the fsm 0, starving after 3 ticks without update, is updated by the fourth tick
+
+ @endut */
+TEST(fsm_budget, updates_starving_instances_before_woken_instances)
+{
+    Fleet fleet;
+    FsmBudgetedDriver driver;
+    fleet.add_to(driver);
+    driver.set_starvation_limit(2);
+
+    FsmBudgetedDriver::Budget budget;
+    budget.max_updates = 1;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        driver.wake(fleet.instances[4]);
+        driver.tick(budget);
+    }
+
+    EXPECT_THAT(fleet.updates, ::testing::ElementsAre(4, 4, 4, 0));
+    EXPECT_EQ(driver.get_stats().starving_updates, 1u);
+}
+
+/** @utdef{UT-FSMBUDGET-0060 | The budgeted driver must remove the exited instances}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0290
+
+    - GIVEN a driver with a fleet of 5 fsm, the fsm 1 being exited
+    - WHEN 2 ticks are run without budget
+    - THEN the fsm 1 is removed from the driver by the first tick, and the second tick updates the 4 other fsm
+
+ @endut */
+TEST(fsm_budget, removes_exited_instances)
+{
+    Fleet fleet;
+    FsmBudgetedDriver driver;
+    fleet.add_to(driver);
+
+    fleet.instances[1].exit();
+
+    EXPECT_EQ(driver.tick({}), 5u);
+    EXPECT_EQ(driver.size(), 4u);
+
+    fleet.updates.clear();
+    EXPECT_EQ(driver.tick({}), 4u);
+    EXPECT_THAT(fleet.updates, ::testing::UnorderedElementsAre(0, 2, 3, 4));
+}
+
+/** @utdef{UT-FSMBUDGET-0070 | The time stamp counter must convert its ticks to durations}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0310
+
+    - GIVEN two timestamps of the time stamp counter, read before and after a 10 ms sleep
+    - WHEN their difference is converted to a duration
+    - THEN the duration is at least 9 ms and less than 1 s
+
+ @endut */
+TEST(fsm_budget, time_stamp_counter_converts_ticks_to_durations)
+{
+    auto start = Tsc::now();
+    std::this_thread::sleep_for(10ms);
+    auto elapsed = Tsc::to_duration(Tsc::now() - start);
+
+    EXPECT_GE(elapsed, 9ms);
+    EXPECT_LT(elapsed, 1s);
+    EXPECT_NEAR(static_cast<double>(Tsc::to_duration(Tsc::to_ticks(1ms)).count()), 1e6, 1e3);
+}
+
+/** @utdef{UT-FSMBUDGET-0080 | An instance woken after its update in a tick must be updated in priority on the next tick}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0290, DNFW-SRS-FSM-0320
+
+    - GIVEN a driver with a fleet of 4 fsm, the update of the fsm 1 waking the fsm 0
+    - WHEN a tick is run with a budget of 3 updates, then a tick with a budget of 1 update
+    - THEN the first tick updates the fsm 0, 1 and 2 (the fsm 0 only once), and the second tick updates the fsm 0
+    -  AND a single overdue update is counted
+
+ @endut */
+TEST(fsm_budget, instance_woken_after_its_update_is_updated_on_next_tick)
+{
+    std::array<Fsm, 4> instances;
+    std::vector<int> updates;
+    FsmBudgetedDriver driver;
+
+    for (int i = 0; i < static_cast<int>(instances.size()); ++i)
+    {
+        instances[i].register_state(FleetState::Running, nullptr, [&, i](){
+            updates.push_back(i);
+            if (i == 1)
+                driver.wake(instances[0]);
+        }, nullptr);
+        instances[i].set_initial_state(FleetState::Running);
+        instances[i].start();
+        driver.add(instances[i]);
+    }
+
+    FsmBudgetedDriver::Budget budget;
+    budget.max_updates = 3;
+    EXPECT_EQ(driver.tick(budget), 3u);
+    EXPECT_EQ(driver.get_stats().overdue_updates, 0u);
+
+    budget.max_updates = 1;
+    EXPECT_EQ(driver.tick(budget), 1u);
+
+    EXPECT_THAT(updates, ::testing::ElementsAre(0, 1, 2, 0));
+    EXPECT_EQ(driver.get_stats().overdue_updates, 1u);
+}
+
+/** @utdef{UT-FSMBUDGET-0090 | A tick must end when an update removes an instance not updated yet}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0290
+
+    - GIVEN a driver with a fleet of 4 fsm, the update of the fsm 0 removing the fsm 2 from the driver
+    - WHEN a tick is run without budget limit
+    - THEN the tick ends after updating the fsm 0, 1 and 3, without counting an exhausted tick, and 3 instances are left
+
+ @endut */
+TEST(fsm_budget, tick_ends_when_an_update_removes_a_pending_instance)
+{
+    std::array<Fsm, 4> instances;
+    std::vector<int> updates;
+    FsmBudgetedDriver driver;
+
+    for (int i = 0; i < static_cast<int>(instances.size()); ++i)
+    {
+        instances[i].register_state(FleetState::Running, nullptr, [&, i](){
+            updates.push_back(i);
+            if (i == 0)
+                driver.remove(instances[2]);
+        }, nullptr);
+        instances[i].set_initial_state(FleetState::Running);
+        instances[i].start();
+        driver.add(instances[i]);
+    }
+
+    EXPECT_EQ(driver.tick(FsmBudgetedDriver::Budget{}), 3u);
+    EXPECT_THAT(updates, ::testing::ElementsAre(0, 1, 3));
+    EXPECT_EQ(driver.get_stats().exhausted_ticks, 0u);
+    EXPECT_EQ(driver.size(), 3u);
+}
+
+/** @utdef{UT-FSMBUDGET-0100 | An instance removed while woken must be added again without wake}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0290, DNFW-SRS-FSM-0320
+
+    - GIVEN a driver with a fleet of 5 fsm, the fsm 4 being woken
+    - WHEN the fsm 4 is removed and added again, and 2 ticks are run with a budget of 1 update
+    - THEN the ticks update the fsm 0 and 1 from the round-robin, and no overdue update is counted
+
+ @endut */
+TEST(fsm_budget, instance_removed_while_woken_is_added_again_without_wake)
+{
+    Fleet fleet;
+    FsmBudgetedDriver driver;
+    fleet.add_to(driver);
+
+    driver.wake(fleet.instances[4]);
+    driver.remove(fleet.instances[4]);
+    driver.add(fleet.instances[4]);
+
+    FsmBudgetedDriver::Budget budget;
+    budget.max_updates = 1;
+    EXPECT_EQ(driver.tick(budget), 1u);
+    EXPECT_EQ(driver.tick(budget), 1u);
+
+    EXPECT_THAT(fleet.updates, ::testing::ElementsAre(0, 1));
+    EXPECT_EQ(driver.get_stats().overdue_updates, 0u);
+}
@@ -0,0 +1,348 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <utils/Fsm/Fsm.h>
+#include <utils/ThreadPool/ThreadPool.h>
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <vector>
+
+using app::utils::Fsm;
+using app::utils::ThreadPool;
+
+namespace
+{
+    enum struct Region
+    {
+        Connection,
+        Authentication
+    };
+
+    enum struct ConnectionState
+    {
+        Disconnected,
+        Connected
+    };
+
+    enum struct AuthenticationState
+    {
+        Anonymous,
+        Challenged,
+        Authenticated
+    };
+}
+
+/** @utdef{UT-FSMREGIONS-0010 | The regions of a fsm must be started and updated with the fsm}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0360, DNFW-SRS-FSM-0370
+
+    - GIVEN a fsm without state, with a connection region and an authentication region
+    - WHEN the fsm is started and updated
+    - THEN each region is started in its initial state, and its current state is updated independently of the other region
+
+ @endut */
+TEST(fsm_regions, regions_are_started_and_updated_with_the_fsm)
+{
+    Fsm fsm;
+    std::vector<std::string> calls;
+
+    auto& connection = fsm.region(Region::Connection);
+    connection.register_state(ConnectionState::Disconnected, [&calls](){calls.push_back("connection enter");}, [&connection](){connection.transition_to(ConnectionState::Connected);}, nullptr);
+    connection.register_state(ConnectionState::Connected, nullptr, [](){}, nullptr);
+    connection.set_initial_state(ConnectionState::Disconnected);
+
+    auto& authentication = fsm.region(Region::Authentication);
+    authentication.register_state(AuthenticationState::Anonymous, [&calls](){calls.push_back("authentication enter");}, [&calls](){calls.push_back("authentication do");}, nullptr);
+    authentication.set_initial_state(AuthenticationState::Anonymous);
+
+    EXPECT_EQ(&fsm.region(Region::Connection), &connection);
+    EXPECT_EQ(fsm.regions_count(), 2u);
+
+    fsm.start();
+    EXPECT_TRUE(fsm.update());
+
+    EXPECT_THAT(calls, ::testing::ElementsAre("connection enter", "authentication enter", "authentication do"));
+    EXPECT_TRUE(connection.is_in_state(ConnectionState::Connected));
+    EXPECT_TRUE(authentication.is_in_state(AuthenticationState::Anonymous));
+}
+
+/** @utdef{UT-FSMREGIONS-0020 | The transition overrides of a region must apply to this region only}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0360
+
+    - GIVEN a fsm with an authentication region overriding the transition Anonymous -> Authenticated to Challenged
+    - WHEN the region transitions from Anonymous to Authenticated
+    - THEN the region goes to the Challenged state
+
+ @endut */
+TEST(fsm_regions, transition_overrides_apply_to_their_region)
+{
+    Fsm fsm;
+    auto& connection = fsm.region(Region::Connection);
+    connection.register_state(ConnectionState::Disconnected, nullptr, [](){}, nullptr);
+    connection.set_initial_state(ConnectionState::Disconnected);
+
+    auto& authentication = fsm.region(Region::Authentication);
+    authentication.register_state(AuthenticationState::Anonymous, nullptr, [](){}, nullptr);
+    authentication.register_state(AuthenticationState::Challenged, nullptr, [](){}, nullptr);
+    authentication.register_state(AuthenticationState::Authenticated, nullptr, [](){}, nullptr);
+    authentication.set_initial_state(AuthenticationState::Anonymous);
+    authentication.transition_override(AuthenticationState::Anonymous, AuthenticationState::Authenticated, AuthenticationState::Challenged);
+
+    fsm.start();
+    authentication.transition_to(AuthenticationState::Authenticated);
+
+    EXPECT_TRUE(authentication.is_in_state(AuthenticationState::Challenged));
+    EXPECT_TRUE(connection.is_in_state(ConnectionState::Disconnected));
+}
+
+/** @utdef{UT-FSMREGIONS-0030 | Exiting a fsm must exit all its regions}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0380
+
+    - GIVEN a started fsm with a state and two regions
+    - WHEN the fsm is exited
+    - THEN the exit functions of the regions, then of the fsm are called, and the fsm and its regions are exited
+
+ @endut */
+TEST(fsm_regions, exiting_the_fsm_exits_all_regions)
+{
+    Fsm fsm;
+    std::vector<std::string> calls;
+
+    fsm.register_state(ConnectionState::Connected, nullptr, [](){}, [&calls](){calls.push_back("fsm exit");});
+    fsm.set_initial_state(ConnectionState::Connected);
+
+    auto& connection = fsm.region(Region::Connection);
+    connection.register_state(ConnectionState::Disconnected, nullptr, [](){}, [&calls](){calls.push_back("connection exit");});
+    connection.set_initial_state(ConnectionState::Disconnected);
+
+    auto& authentication = fsm.region(Region::Authentication);
+    authentication.register_state(AuthenticationState::Anonymous, nullptr, [](){}, [&calls](){calls.push_back("authentication exit");});
+    authentication.set_initial_state(AuthenticationState::Anonymous);
+
+    fsm.start();
+    fsm.exit();
+
+    EXPECT_THAT(calls, ::testing::ElementsAre("connection exit", "authentication exit", "fsm exit"));
+    EXPECT_TRUE(fsm.is_exit());
+    EXPECT_TRUE(connection.is_exit());
+    EXPECT_TRUE(authentication.is_exit());
+    EXPECT_FALSE(fsm.update());
+}
+
+/** @utdef{UT-FSMREGIONS-0040 | The exit of a region must exit the whole fsm}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0380
+
+    - GIVEN a started fsm with two regions, the connection region exiting on its first update
+    - WHEN the fsm is updated
+    - THEN the update returns false, and the other region is exited
+
+ @endut */
+TEST(fsm_regions, exit_of_a_region_exits_the_fsm)
+{
+    Fsm fsm;
+    bool authentication_exited = false;
+
+    auto& connection = fsm.region(Region::Connection);
+    connection.register_state(ConnectionState::Disconnected, nullptr, [&connection](){connection.exit();}, nullptr);
+    connection.set_initial_state(ConnectionState::Disconnected);
+
+    auto& authentication = fsm.region(Region::Authentication);
+    authentication.register_state(AuthenticationState::Anonymous, nullptr, [](){}, [&authentication_exited](){authentication_exited = true;});
+    authentication.set_initial_state(AuthenticationState::Anonymous);
+
+    fsm.start();
+
+    EXPECT_FALSE(fsm.update());
+    EXPECT_TRUE(fsm.is_exit());
+    EXPECT_TRUE(authentication_exited);
+}
+
+/** @utdef{UT-FSMREGIONS-0050 | Adding a region to a started fsm must throw an exception}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0360
+
+    - GIVEN a started fsm with a region
+    - WHEN a new region is added
+    - THEN an exception is thrown, but the existing region is still returned
+
+ @endut */
+TEST(fsm_regions, adding_a_region_to_a_started_fsm_throws_exception)
+{
+    Fsm fsm;
+    auto& connection = fsm.region(Region::Connection);
+    connection.register_state(ConnectionState::Disconnected, nullptr, [](){}, nullptr);
+    connection.set_initial_state(ConnectionState::Disconnected);
+    fsm.start();
+
+    EXPECT_THROW(fsm.region(Region::Authentication), std::runtime_error);
+    EXPECT_EQ(&fsm.region(Region::Connection), &connection);
+    EXPECT_THROW(fsm.start(), std::runtime_error);
+}
+
+/** @utdef{UT-FSMREGIONS-0060 | The regions must be updated in parallel on a thread pool}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0390
+
+    - GIVEN a started fsm with 4 regions updated on a thread pool of 3 threads, each region counting its updates
+    - WHEN the fsm is updated 100 times
+    - THEN each region is updated 100 times, and all the region updates are done when the fsm update returns
+
+ @endut */
+TEST(fsm_regions, regions_are_updated_in_parallel_on_a_thread_pool)
+{
+    enum struct ParallelRegion { First, Second, Third, Fourth };
+
+    ThreadPool pool(3);
+    Fsm fsm;
+    fsm.set_region_thread_pool(&pool);
+
+    std::array<std::atomic<int>, 4> updates{};
+    for (auto [region_id, index] : {std::pair{ParallelRegion::First, 0}, {ParallelRegion::Second, 1}, {ParallelRegion::Third, 2}, {ParallelRegion::Fourth, 3}})
+    {
+        auto& region = fsm.region(region_id);
+        region.register_state(ConnectionState::Connected, nullptr, [&updates, index = index](){updates[index]++;}, nullptr);
+        region.set_initial_state(ConnectionState::Connected);
+    }
+
+    fsm.start();
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_TRUE(fsm.update());
+        for (auto& count : updates)
+            EXPECT_EQ(count.load(), i + 1);
+    }
+}
+
+/** @utdef{UT-FSMREGIONS-0070 | An exception thrown by a region updated on a thread pool must be rethrown by the fsm update}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0390
+
+    - GIVEN a started fsm with 2 regions updated on a thread pool, the second region having no do function
+    - WHEN the fsm is updated
+    - THEN an exception is thrown
+
+ @endut */
+TEST(fsm_regions, exception_of_a_parallel_region_is_rethrown)
+{
+    ThreadPool pool(2);
+    Fsm fsm;
+    fsm.set_region_thread_pool(&pool);
+
+    auto& connection = fsm.region(Region::Connection);
+    connection.register_state(ConnectionState::Disconnected, nullptr, [](){}, nullptr);
+    connection.set_initial_state(ConnectionState::Disconnected);
+
+    auto& authentication = fsm.region(Region::Authentication);
+    authentication.register_state(AuthenticationState::Anonymous, nullptr, nullptr, nullptr);
+    authentication.set_initial_state(AuthenticationState::Anonymous);
+
+    fsm.start();
+    EXPECT_THROW(fsm.update(), std::runtime_error);
+}
+
+/** @utdef{UT-FSMREGIONS-0080 | A fsm without region must be restartable after an exit}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0370
+
+    - GIVEN a started fsm without any region, which is then exited
+    - WHEN its initial state is set again and it is started
+    - THEN no exception is thrown, and the fsm is running again
+
+ @endut */
+TEST(fsm_regions, fsm_without_region_is_restartable_after_exit)
+{
+    Fsm fsm;
+    fsm.register_state(ConnectionState::Disconnected, nullptr, [](){}, nullptr);
+    fsm.set_initial_state(ConnectionState::Disconnected);
+    fsm.start();
+    fsm.exit();
+
+    fsm.set_initial_state(ConnectionState::Disconnected);
+
+    EXPECT_NO_THROW(fsm.start());
+    EXPECT_TRUE(fsm.update());
+}
+
+/** @utdef{UT-FSMREGIONS-0090 | A fsm with regions must be restartable after an exit}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0360, DNFW-SRS-FSM-0370
+
+    - GIVEN a fsm without state, with a connection region and an authentication region, started then exited
+    - WHEN the fsm is started again and updated
+    - THEN no exception is thrown, each region is entered again in its initial state, and the fsm is running again
+
+ @endut */
+TEST(fsm_regions, fsm_with_regions_is_restartable_after_exit)
+{
+    Fsm fsm;
+    std::vector<std::string> calls;
+
+    auto& connection = fsm.region(Region::Connection);
+    connection.register_state(ConnectionState::Disconnected, [&calls](){calls.push_back("connection enter");}, [&connection](){connection.transition_to(ConnectionState::Connected);}, nullptr);
+    connection.register_state(ConnectionState::Connected, nullptr, [](){}, nullptr);
+    connection.set_initial_state(ConnectionState::Disconnected);
+
+    auto& authentication = fsm.region(Region::Authentication);
+    authentication.register_state(AuthenticationState::Anonymous, [&calls](){calls.push_back("authentication enter");}, [](){}, nullptr);
+    authentication.set_initial_state(AuthenticationState::Anonymous);
+
+    fsm.start();
+    EXPECT_TRUE(fsm.update());
+    EXPECT_TRUE(connection.is_in_state(ConnectionState::Connected));
+    fsm.exit();
+    ASSERT_TRUE(fsm.is_exit());
+
+    EXPECT_NO_THROW(fsm.start());
+    EXPECT_FALSE(fsm.is_exit());
+    EXPECT_TRUE(connection.is_in_state(ConnectionState::Disconnected));
+    EXPECT_TRUE(authentication.is_in_state(AuthenticationState::Anonymous));
+    EXPECT_TRUE(fsm.update());
+    EXPECT_THAT(calls, ::testing::ElementsAre("connection enter", "authentication enter", "connection enter", "authentication enter"));
+}
+
+/** @utdef{UT-FSMREGIONS-0100 | A fsm with a state and regions must be restartable after an exit}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0360, DNFW-SRS-FSM-0370
+
+    - GIVEN a fsm with a state and a connection region, started then exited
+    - WHEN the fsm is started again, then its initial state is set again and it is started
+    - THEN the first start throws as for any exited fsm, and the second one enters the state of the fsm and the initial state of the region
+
+ @endut */
+TEST(fsm_regions, fsm_with_state_and_regions_is_restartable_after_exit)
+{
+    Fsm fsm;
+    std::vector<std::string> calls;
+
+    fsm.register_state(AuthenticationState::Anonymous, [&calls](){calls.push_back("fsm enter");}, [](){}, nullptr);
+    fsm.set_initial_state(AuthenticationState::Anonymous);
+
+    auto& connection = fsm.region(Region::Connection);
+    connection.register_state(ConnectionState::Disconnected, [&calls](){calls.push_back("connection enter");}, [](){}, nullptr);
+    connection.set_initial_state(ConnectionState::Disconnected);
+
+    fsm.start();
+    fsm.exit();
+
+    EXPECT_THROW(fsm.start(), std::runtime_error);
+
+    fsm.set_initial_state(AuthenticationState::Anonymous);
+    EXPECT_NO_THROW(fsm.start());
+    EXPECT_TRUE(connection.is_in_state(ConnectionState::Disconnected));
+    EXPECT_TRUE(fsm.update());
+    EXPECT_THAT(calls, ::testing::ElementsAre("fsm enter", "connection enter", "fsm enter", "connection enter"));
+}
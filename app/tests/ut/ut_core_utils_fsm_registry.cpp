@@ -0,0 +1,257 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <utils/Fsm/FsmRegistry.h>
+
+#include <set>
+
+using app::utils::Fsm;
+using app::utils::FsmRegistry;
+
+namespace
+{
+    enum struct EntityState
+    {
+        Alive
+    };
+}
+
+/** @utdef{UT-FSMREGISTRY-0010 | The registry must find an instance by its handle}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0330
+
+    - GIVEN a registry with 3 created instances
+    - WHEN the instances are looked up by their handle
+    - THEN each handle gives its own instance, and the registry contains 3 instances
+
+ @endut */
+TEST(fsm_registry, finds_instances_by_handle)
+{
+    FsmRegistry registry;
+    auto first = registry.create();
+    auto second = registry.create();
+    auto third = registry.create();
+
+    ASSERT_NE(registry.find(first), nullptr);
+    EXPECT_NE(registry.find(first), registry.find(second));
+    EXPECT_NE(registry.find(second), registry.find(third));
+    EXPECT_EQ(&registry.at(second), registry.find(second));
+    EXPECT_TRUE(registry.contains(third));
+    EXPECT_EQ(registry.size(), 3u);
+}
+
+/** @utdef{UT-FSMREGISTRY-0020 | The handles of a destroyed instance must be stale}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0330, DNFW-SRS-FSM-0340
+
+    - GIVEN a registry with a created instance
+    - WHEN the instance is destroyed, then a new instance is created in the freed slot
+    - THEN the handle of the destroyed instance is stale (lookup fails, at() throws, destroy fails) and the new handle is different
+
+ @endut */
+TEST(fsm_registry, handles_of_destroyed_instances_are_stale)
+{
+    FsmRegistry registry;
+    auto destroyed = registry.create();
+    auto* destroyed_fsm = registry.find(destroyed);
+
+    EXPECT_TRUE(registry.destroy(destroyed));
+    auto reused = registry.create();
+
+    EXPECT_EQ(registry.find(reused), destroyed_fsm);
+    EXPECT_NE(reused, destroyed);
+    EXPECT_EQ(registry.find(destroyed), nullptr);
+    EXPECT_FALSE(registry.contains(destroyed));
+    EXPECT_THROW(registry.at(destroyed), std::runtime_error);
+    EXPECT_FALSE(registry.destroy(destroyed));
+    EXPECT_EQ(registry.size(), 1u);
+}
+
+/** @utdef{UT-FSMREGISTRY-0030 | The default handle must be stale}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0340
+
+    - GIVEN a registry with a created instance
+    - WHEN the instance is looked up with a default handle
+    - THEN the lookup fails
+
+ @endut */
+TEST(fsm_registry, default_handle_is_stale)
+{
+    FsmRegistry registry;
+    registry.create();
+
+    EXPECT_EQ(registry.find(FsmRegistry::Handle{}), nullptr);
+}
+
+/** @utdef{UT-FSMREGISTRY-0040 | The registry must reuse the freed slots}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0340
+
+    - GIVEN a registry with a full chunk of created instances
+    - WHEN all the instances are destroyed and as many instances are created again, twice
+    - THEN the registry does not allocate new slots
+
+ @endut */
+TEST(fsm_registry, reuses_freed_slots)
+{
+    FsmRegistry registry;
+    std::vector<FsmRegistry::Handle> handles;
+
+    for (int round = 0; round < 3; ++round)
+    {
+        for (std::size_t i = 0; i < FsmRegistry::chunk_size; ++i)
+            handles.push_back(registry.create());
+        for (auto handle : handles)
+            EXPECT_TRUE(registry.destroy(handle));
+        handles.clear();
+    }
+
+    EXPECT_EQ(registry.size(), 0u);
+    EXPECT_EQ(registry.capacity(), FsmRegistry::chunk_size);
+}
+
+/** @utdef{UT-FSMREGISTRY-0050 | The registry must iterate over the live instances only}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0350
+
+    - GIVEN a registry with 5 created instances, the second and the fourth being destroyed
+    - WHEN the registry iterates over its instances, destroying the third one while it is visited
+    - THEN the first, third and fifth instances are visited once, and the registry contains 2 instances
+
+ @endut */
+TEST(fsm_registry, iterates_over_live_instances)
+{
+    FsmRegistry registry;
+    std::vector<FsmRegistry::Handle> handles;
+    for (int i = 0; i < 5; ++i)
+        handles.push_back(registry.create());
+    registry.destroy(handles[1]);
+    registry.destroy(handles[3]);
+
+    std::multiset<std::uint64_t> visited;
+    registry.for_each([&](FsmRegistry::Handle handle, Fsm& fsm)
+    {
+        EXPECT_EQ(registry.find(handle), &fsm);
+        visited.insert(handle.value);
+        if (handle == handles[2])
+            registry.destroy(handle);
+    });
+
+    EXPECT_THAT(visited, ::testing::UnorderedElementsAre(handles[0].value, handles[2].value, handles[4].value));
+    EXPECT_EQ(registry.size(), 2u);
+}
+
+/** @utdef{UT-FSMREGISTRY-0060 | The registry must update all the live instances}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0350
+
+    - GIVEN a registry with 3 started instances, one of them being exited
+    - WHEN all the instances are updated
+    - THEN the 2 running instances are updated and 1 exited instance is reported
+
+ @endut */
+TEST(fsm_registry, updates_all_live_instances)
+{
+    FsmRegistry registry;
+    int updates = 0;
+
+    std::vector<FsmRegistry::Handle> handles;
+    for (int i = 0; i < 3; ++i)
+    {
+        auto handle = registry.create();
+        auto& fsm = registry.at(handle);
+        fsm.register_state(EntityState::Alive, nullptr, [&updates](){updates++;}, nullptr);
+        fsm.set_initial_state(EntityState::Alive);
+        fsm.start();
+        handles.push_back(handle);
+    }
+    registry.at(handles[1]).exit();
+
+    EXPECT_EQ(registry.update_all(), 1u);
+    EXPECT_EQ(updates, 2);
+}
+
+/** @utdef{UT-FSMREGISTRY-0070 | The registry must update all the instances while updates destroy and create instances}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0350
+
+    - GIVEN a registry with 4 started instances, the update of the last one destroying the first one and the update of the third one
+      creating a new instance
+    - WHEN all the instances are updated
+    - THEN each of the second, third and last instances is updated once, the destroyed and created instances are not updated, and the registry
+      contains 4 instances
+
+ @endut */
+TEST(fsm_registry, updates_all_instances_while_updates_destroy_and_create_instances)
+{
+    FsmRegistry registry;
+    std::vector<FsmRegistry::Handle> handles;
+    std::vector<int> updates(4, 0);
+    for (int i = 0; i < 4; ++i)
+        handles.push_back(registry.create());
+
+    for (int i = 0; i < 4; ++i)
+    {
+        auto& fsm = registry.at(handles[i]);
+        fsm.register_state(EntityState::Alive, nullptr, [&, i]()
+        {
+            updates[i]++;
+            if (i == 3)
+                registry.destroy(handles[0]);
+            if (i == 2)
+                registry.create();
+        }, nullptr);
+        fsm.set_initial_state(EntityState::Alive);
+        fsm.start();
+    }
+
+    EXPECT_EQ(registry.update_all(), 0u);
+    EXPECT_THAT(updates, ::testing::ElementsAre(0, 1, 1, 1));
+    EXPECT_EQ(registry.size(), 4u);
+}
+
+/** @utdef{UT-FSMREGISTRY-0080 | The registry must visit each instance at most once while the visits destroy and create instances}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0350
+
+    - GIVEN a registry with 4 created instances
+    - WHEN the registry iterates over its instances, the visit of the last one destroying the first one, and the visit of the third one
+      creating a new instance and destroying the second one (each destroy moving an instance already visited or created to an index not
+      visited yet)
+    - THEN the last and third instances are visited once, the destroyed and created instances are not visited, and the registry contains
+      3 instances
+
+ @endut */
+TEST(fsm_registry, iterates_once_over_instances_while_visits_destroy_and_create_instances)
+{
+    FsmRegistry registry;
+    std::vector<FsmRegistry::Handle> handles;
+    for (int i = 0; i < 4; ++i)
+        handles.push_back(registry.create());
+
+    std::multiset<std::uint64_t> visited;
+    FsmRegistry::Handle created;
+    registry.for_each([&](FsmRegistry::Handle handle, Fsm&)
+    {
+        visited.insert(handle.value);
+        if (handle == handles[3])
+            registry.destroy(handles[0]);
+        if (handle == handles[2])
+        {
+            created = registry.create();
+            registry.destroy(handles[1]);
+        }
+    });
+
+    EXPECT_THAT(visited, ::testing::UnorderedElementsAre(handles[2].value, handles[3].value));
+    EXPECT_TRUE(registry.contains(created));
+    EXPECT_EQ(registry.size(), 3u);
+}
@@ -0,0 +1,457 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <utils/Fsm/FsmScheduler.h>
+
+#include <array>
+#include <stdexcept>
+#include <thread>
+
+using app::utils::Fsm;
+using app::utils::FsmScheduler;
+using namespace std::chrono_literals;
+
+namespace
+{
+    /* Clock whose time is set by the test */
+    struct ManualClock
+    {
+        using duration = std::chrono::nanoseconds;
+        using rep = duration::rep;
+        using period = duration::period;
+        using time_point = std::chrono::time_point<ManualClock>;
+        static constexpr bool is_steady = true;
+
+        static inline time_point current{};
+        static time_point now() { return current; }
+    };
+
+    enum struct PeriodicState
+    {
+        Fast,
+        Slow
+    };
+
+    using Scheduler = FsmScheduler<ManualClock>;
+}
+
+/** @utdef{UT-FSMSCHEDULER-0010 | The scheduler must update each instance at the period of its current state}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0260, DNFW-SRS-FSM-0270
+
+    - GIVEN a fsm in a Fast state with a 1 ms update period, and a fsm in a Slow state with a 1 s update period
+    - WHEN the scheduler runs every 1 ms during 1 s
+    - THEN the fast fsm is updated 1001 times and the slow fsm is updated 2 times (at 0 s and at 1 s)
+
+ @endut */
+TEST(fsm_scheduler, updates_instances_at_the_period_of_their_state)
+{
+    ManualClock::current = {};
+    int fast_updates = 0;
+    int slow_updates = 0;
+
+    Fsm fast;
+    fast.register_state(PeriodicState::Fast, Fsm::UpdatePeriod{1ms}, nullptr, [&fast_updates](){fast_updates++;}, nullptr);
+    fast.set_initial_state(PeriodicState::Fast);
+    fast.start();
+
+    Fsm slow;
+    slow.register_state(PeriodicState::Slow, Fsm::UpdatePeriod{1s}, nullptr, [&slow_updates](){slow_updates++;}, nullptr);
+    slow.set_initial_state(PeriodicState::Slow);
+    slow.start();
+
+    Scheduler scheduler;
+    scheduler.add(fast);
+    scheduler.add(slow);
+
+    for (int ms = 0; ms <= 1000; ++ms)
+    {
+        ManualClock::current = ManualClock::time_point(std::chrono::milliseconds(ms));
+        scheduler.run_due();
+    }
+
+    EXPECT_EQ(fast_updates, 1001);
+    EXPECT_EQ(slow_updates, 2);
+    EXPECT_EQ(scheduler.get_stats().deadline_misses, 0u);
+    EXPECT_EQ(scheduler.next_deadline(), ManualClock::time_point(1001ms));
+}
+
+/** @utdef{UT-FSMSCHEDULER-0020 | The scheduler must use the period of the new state after a transition}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0260, DNFW-SRS-FSM-0270
+
+    - GIVEN a fsm in a Fast state (1 ms period) that transitions to a Slow state (1 s period) on its first update
+    - WHEN the scheduler runs at 0 ms
+    - THEN the next deadline is 1 s
+
+ @endut */
+TEST(fsm_scheduler, reschedules_with_the_period_of_the_new_state)
+{
+    ManualClock::current = {};
+
+    Fsm fsm;
+    fsm.register_state(PeriodicState::Fast, Fsm::UpdatePeriod{1ms}, nullptr, [&fsm](){fsm.transition_to(PeriodicState::Slow);}, nullptr);
+    fsm.register_state(PeriodicState::Slow, Fsm::UpdatePeriod{1s}, nullptr, [](){}, nullptr);
+    fsm.set_initial_state(PeriodicState::Fast);
+    fsm.start();
+
+    Scheduler scheduler;
+    scheduler.add(fsm);
+
+    EXPECT_EQ(scheduler.run_due(), 1u);
+    EXPECT_EQ(scheduler.next_deadline(), ManualClock::time_point(1s));
+}
+
+/** @utdef{UT-FSMSCHEDULER-0030 | The scheduler must report the updates later than their deadline plus the tolerance}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0280
+
+    - GIVEN a fsm with a 1 ms update period, scheduled at 0 ms, and a miss tolerance of 100 us
+    - WHEN the scheduler runs at 0 ms, 1.05 ms and 3 ms
+    - THEN one deadline miss is reported (at 3 ms, 1 ms late), and the maximum lateness is 1 ms
+    -  AND the next deadline is 4 ms (the missed periods are skipped)
+
+ @endut */
+TEST(fsm_scheduler, reports_deadline_misses)
+{
+    ManualClock::current = {};
+
+    Fsm fsm;
+    fsm.register_state(PeriodicState::Fast, Fsm::UpdatePeriod{1ms}, nullptr, [](){}, nullptr);
+    fsm.set_initial_state(PeriodicState::Fast);
+    fsm.start();
+
+    Scheduler scheduler;
+    std::vector<ManualClock::duration> misses;
+    scheduler.set_miss_tolerance(100us);
+    scheduler.on_deadline_miss([&misses](Fsm&, ManualClock::duration lateness){misses.push_back(lateness);});
+    scheduler.add(fsm);
+
+    scheduler.run_due(ManualClock::time_point(0ms));
+    scheduler.run_due(ManualClock::time_point(1050us));
+    scheduler.run_due(ManualClock::time_point(3ms));
+
+    EXPECT_EQ(scheduler.get_stats().updates, 3u);
+    EXPECT_EQ(scheduler.get_stats().deadline_misses, 1u);
+    EXPECT_EQ(scheduler.get_stats().max_lateness, 1ms);
+    EXPECT_THAT(misses, testing::ElementsAre(ManualClock::duration(1ms)));
+    EXPECT_EQ(scheduler.next_deadline(), ManualClock::time_point(4ms));
+}
+
+/** @utdef{UT-FSMSCHEDULER-0040 | The exited and removed instances must not be updated anymore}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0270
+
+    - GIVEN a fsm that exits on its first update, and a fsm removed from the scheduler
+    - WHEN the scheduler runs twice
+    - THEN the first fsm is updated once, the removed fsm is never updated, and no instance is scheduled anymore
+
+ @endut */
+TEST(fsm_scheduler, exited_and_removed_instances_are_not_updated)
+{
+    ManualClock::current = {};
+    int exiting_updates = 0;
+    int removed_updates = 0;
+
+    Fsm exiting;
+    exiting.register_state(PeriodicState::Fast, nullptr, [&](){exiting_updates++; exiting.exit();}, nullptr);
+    exiting.set_initial_state(PeriodicState::Fast);
+    exiting.start();
+
+    Fsm removed;
+    removed.register_state(PeriodicState::Fast, nullptr, [&](){removed_updates++;}, nullptr);
+    removed.set_initial_state(PeriodicState::Fast);
+    removed.start();
+
+    Scheduler scheduler;
+    scheduler.add(exiting);
+    scheduler.add(removed);
+    scheduler.remove(removed);
+
+    scheduler.run_due();
+    scheduler.run_due();
+
+    EXPECT_EQ(exiting_updates, 1);
+    EXPECT_EQ(removed_updates, 0);
+    EXPECT_EQ(scheduler.size(), 0u);
+    EXPECT_FALSE(scheduler.next_deadline().has_value());
+}
+
+/** @utdef{UT-FSMSCHEDULER-0050 | An update throwing an exception must not drop instances from the scheduler}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0270
+
+    - GIVEN three fsm with a 1 ms update period, due at 0 us, 1 us and 2 us, the second one throwing on its first update
+    - WHEN the scheduler runs at 1 ms, then at 2 ms
+    - THEN the first run propagates the exception after updating the first fsm only
+    -  AND the second run updates the three fsm: the first and the second ones were rescheduled, the third one is still due
+
+ @endut */
+TEST(fsm_scheduler, throwing_update_does_not_drop_instances)
+{
+    int updates[3] = {0, 0, 0};
+    Fsm fleet[3];
+
+    for (int i = 0; i < 3; ++i)
+    {
+        fleet[i].register_state(PeriodicState::Fast, Fsm::UpdatePeriod{1ms}, nullptr, [&updates, i]()
+        {
+            if (++updates[i] == 1 && i == 1)
+                throw std::runtime_error("update failure");
+        }, nullptr);
+        fleet[i].set_initial_state(PeriodicState::Fast);
+        fleet[i].start();
+    }
+
+    Scheduler scheduler;
+    for (int i = 0; i < 3; ++i)
+        scheduler.add(fleet[i], ManualClock::time_point(std::chrono::microseconds(i)));
+
+    EXPECT_THROW(scheduler.run_due(ManualClock::time_point(1ms)), std::runtime_error);
+    EXPECT_EQ(updates[0], 1);
+    EXPECT_EQ(updates[1], 1);
+    EXPECT_EQ(updates[2], 0);
+    EXPECT_EQ(scheduler.size(), 3u);
+
+    EXPECT_EQ(scheduler.run_due(ManualClock::time_point(2ms)), 3u);
+    EXPECT_EQ(updates[0], 2);
+    EXPECT_EQ(updates[1], 2);
+    EXPECT_EQ(updates[2], 1);
+}
+
+/** @utdef{UT-FSMSCHEDULER-0060 | The jitter of a real clock within the miss tolerance must not be reported as deadline misses}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0270, DNFW-SRS-FSM-0280
+
+    - GIVEN a scheduler on the steady clock, with a miss tolerance of 10 ms, with a fsm with a 20 ms update period and a fsm without update period
+    - WHEN the scheduler runs 10 times, sleeping until the next deadline of the periodic fsm between the runs
+    - THEN no deadline miss is reported, although the updates are later than their deadline by the wake up jitter
+
+ @endut */
+TEST(fsm_scheduler, real_clock_jitter_within_the_tolerance_is_not_a_deadline_miss)
+{
+    Fsm periodic;
+    periodic.register_state(PeriodicState::Slow, Fsm::UpdatePeriod{20ms}, nullptr, [](){}, nullptr);
+    periodic.set_initial_state(PeriodicState::Slow);
+    periodic.start();
+
+    Fsm polled;
+    polled.register_state(PeriodicState::Fast, nullptr, [](){}, nullptr);
+    polled.set_initial_state(PeriodicState::Fast);
+    polled.start();
+
+    FsmScheduler<> scheduler;
+    scheduler.set_miss_tolerance(10ms);
+    scheduler.add(periodic);
+    scheduler.add(polled);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int run = 0; run < 10; ++run)
+    {
+        scheduler.run_due();
+        std::this_thread::sleep_until(start + (run + 1) * 20ms);
+    }
+
+    EXPECT_EQ(scheduler.get_stats().updates, 20u);
+    EXPECT_GT(scheduler.get_stats().max_lateness, std::chrono::steady_clock::duration::zero());
+    EXPECT_EQ(scheduler.get_stats().deadline_misses, 0u);
+}
+
+/** @utdef{UT-FSMSCHEDULER-0070 | The instances without update period must wait for the minimum update period without being late}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0270, DNFW-SRS-FSM-0280
+
+    - GIVEN a scheduler with a minimum update period of 10 ms and a null miss tolerance, with a fsm without update period
+    - WHEN the scheduler runs every 5 ms during 20 ms
+    - THEN the fsm is updated every 10 ms only, 3 times, without lateness nor deadline miss
+
+ @endut */
+TEST(fsm_scheduler, min_update_period_reschedules_instances_without_period)
+{
+    ManualClock::current = {};
+    int updates = 0;
+
+    Fsm polled;
+    polled.register_state(PeriodicState::Fast, nullptr, [&updates](){updates++;}, nullptr);
+    polled.set_initial_state(PeriodicState::Fast);
+    polled.start();
+
+    Scheduler scheduler;
+    scheduler.set_min_update_period(10ms);
+    scheduler.set_miss_tolerance(ManualClock::duration::zero());
+    scheduler.add(polled);
+
+    for (auto time = 0ms; time <= 20ms; time += 5ms)
+        scheduler.run_due(ManualClock::time_point(time));
+
+    EXPECT_EQ(updates, 3);
+    EXPECT_EQ(scheduler.get_stats().max_lateness, ManualClock::duration::zero());
+    EXPECT_EQ(scheduler.get_stats().deadline_misses, 0u);
+}
+
+/** @utdef{UT-FSMSCHEDULER-0080 | By default, any update later than its deadline must be reported as a deadline miss}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0280
+
+    - GIVEN a scheduler without miss tolerance set, with a fsm with a 1 s update period added without time, and a fsm without update period
+      added with a deadline at 0 ms
+    - WHEN the scheduler runs at 1 ms and 1.9 s
+    - THEN the fsm without period misses its deadline by 1 ms at 1 ms, the periodic fsm is not late on its first update (added without time)
+      and misses its deadline by 900 ms at 1.9 s, and the fsm without period, due at once after its first update, is not late anymore
+
+ @endut */
+TEST(fsm_scheduler, reports_any_late_update_by_default)
+{
+    ManualClock::current = {};
+
+    Fsm slow;
+    slow.register_state(PeriodicState::Slow, Fsm::UpdatePeriod{1s}, nullptr, [](){}, nullptr);
+    slow.set_initial_state(PeriodicState::Slow);
+    slow.start();
+
+    Fsm polled;
+    polled.register_state(PeriodicState::Fast, nullptr, [](){}, nullptr);
+    polled.set_initial_state(PeriodicState::Fast);
+    polled.start();
+
+    Scheduler scheduler;
+    std::vector<std::pair<Fsm*, ManualClock::duration>> misses;
+    scheduler.on_deadline_miss([&misses](Fsm& fsm, ManualClock::duration lateness){misses.emplace_back(&fsm, lateness);});
+    scheduler.add(slow);
+    scheduler.add(polled, ManualClock::time_point(0ms));
+
+    scheduler.run_due(ManualClock::time_point(1ms));
+    scheduler.run_due(ManualClock::time_point(1900ms));
+
+    EXPECT_THAT(misses, testing::ElementsAre(std::make_pair(&polled, ManualClock::duration(1ms)), std::make_pair(&slow, ManualClock::duration(900ms))));
+    EXPECT_EQ(scheduler.get_stats().deadline_misses, 2u);
+    EXPECT_EQ(scheduler.get_stats().max_lateness, 900ms);
+}
+
+/** @utdef{UT-FSMSCHEDULER-0090 | With the period tolerance, only the updates skipping a whole period must be reported as deadline misses}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0280
+
+    - GIVEN a scheduler tolerating the update period of the instances, with a fsm with a 1 s update period added at 0 s
+    - WHEN the scheduler runs at 0 s, 1.9 s and 3.5 s
+    - THEN only the update at 3.5 s (1.5 s late, more than the period) is reported as a deadline miss
+
+ @endut */
+TEST(fsm_scheduler, period_tolerance_reports_skipped_periods_only)
+{
+    ManualClock::current = {};
+
+    Fsm slow;
+    slow.register_state(PeriodicState::Slow, Fsm::UpdatePeriod{1s}, nullptr, [](){}, nullptr);
+    slow.set_initial_state(PeriodicState::Slow);
+    slow.start();
+
+    Scheduler scheduler;
+    scheduler.set_miss_tolerance(Scheduler::PeriodTolerance{});
+    scheduler.add(slow, ManualClock::time_point(0s));
+
+    scheduler.run_due(ManualClock::time_point(0s));
+    scheduler.run_due(ManualClock::time_point(1900ms));
+    EXPECT_EQ(scheduler.get_stats().deadline_misses, 0u);
+
+    scheduler.run_due(ManualClock::time_point(3500ms));
+    EXPECT_EQ(scheduler.get_stats().deadline_misses, 1u);
+    EXPECT_EQ(scheduler.get_stats().max_lateness, 1500ms);
+}
+
+/** @utdef{UT-FSMSCHEDULER-0100 | An update removing its own instance must not be rescheduled nor removed again}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0270
+
+    - GIVEN a scheduler with a fsm whose update removes it from the scheduler then exits, and a fsm whose update removes it from the
+      scheduler and keeps running
+    - WHEN the scheduler runs twice
+    - THEN each fsm is updated once, by the first pass, and no instance is left in the scheduler
+
+ @endut */
+TEST(fsm_scheduler, update_removing_its_own_instance)
+{
+    ManualClock::current = {};
+    Scheduler scheduler;
+    int exiting_updates = 0;
+    int running_updates = 0;
+
+    Fsm exiting;
+    exiting.register_state(PeriodicState::Fast, nullptr, [&](){
+        exiting_updates++;
+        scheduler.remove(exiting);
+        exiting.exit();
+    }, nullptr);
+    exiting.set_initial_state(PeriodicState::Fast);
+    exiting.start();
+
+    Fsm running;
+    running.register_state(PeriodicState::Fast, nullptr, [&](){
+        running_updates++;
+        scheduler.remove(running);
+    }, nullptr);
+    running.set_initial_state(PeriodicState::Fast);
+    running.start();
+
+    scheduler.add(exiting);
+    scheduler.add(running);
+
+    EXPECT_EQ(scheduler.run_due(ManualClock::time_point(0s)), 2u);
+    EXPECT_EQ(scheduler.run_due(ManualClock::time_point(1ms)), 0u);
+
+    EXPECT_EQ(exiting_updates, 1);
+    EXPECT_EQ(running_updates, 1);
+    EXPECT_EQ(scheduler.size(), 0u);
+    EXPECT_FALSE(scheduler.next_deadline().has_value());
+}
+
+/** @utdef{UT-FSMSCHEDULER-0110 | An update adding instances must not disturb the removal of its own instance}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0270
+
+    - GIVEN a scheduler with a fsm whose update adds 64 fsm to the scheduler (rehashing its instances) then exits
+    - WHEN the scheduler runs twice
+    - THEN the exited fsm is removed, and the 64 added fsm are scheduled and updated by each pass
+
+ @endut */
+TEST(fsm_scheduler, update_adding_instances)
+{
+    ManualClock::current = {};
+    Scheduler scheduler;
+    std::array<Fsm, 64> added;
+    int added_updates = 0;
+
+    for (auto& fsm : added)
+    {
+        fsm.register_state(PeriodicState::Fast, nullptr, [&added_updates](){added_updates++;}, nullptr);
+        fsm.set_initial_state(PeriodicState::Fast);
+        fsm.start();
+    }
+
+    Fsm adding;
+    adding.register_state(PeriodicState::Fast, nullptr, [&](){
+        for (auto& fsm : added)
+            scheduler.add(fsm);
+        adding.exit();
+    }, nullptr);
+    adding.set_initial_state(PeriodicState::Fast);
+    adding.start();
+    scheduler.add(adding);
+
+    EXPECT_EQ(scheduler.run_due(ManualClock::time_point(0s)), 65u);
+    EXPECT_EQ(scheduler.size(), 64u);
+
+    EXPECT_EQ(scheduler.run_due(ManualClock::time_point(1ms)), 64u);
+    EXPECT_EQ(added_updates, 128);
+    EXPECT_EQ(scheduler.size(), 64u);
+}
@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <utils/Fsm/FsmSimulator.h>
+
+#include <memory>
+#include <thread>
+
+using app::utils::Fsm;
+using app::utils::FsmSimulator;
+using app::utils::ThreadPool;
+using app::utils::VirtualClock;
+using namespace std::chrono_literals;
+
+namespace
+{
+    enum struct ServerState
+    {
+        Idle,
+        Busy
+    };
+
+    /* Server polling its queue every minute when idle, and working during 10 updates, every 100 ms, when busy with a request */
+    struct Server
+    {
+        Fsm fsm;
+        FsmSimulator& simulator;
+        VirtualClock::time_point request_time{};
+        int work_left = 0;
+
+        explicit Server(FsmSimulator& simulator) : simulator(simulator)
+        {
+            fsm.register_state(ServerState::Idle, Fsm::UpdatePeriod{1min}, nullptr, [](){}, nullptr);
+            fsm.register_state(ServerState::Busy, Fsm::UpdatePeriod{100ms}, nullptr, [this](){
+                if (--work_left == 0)
+                {
+                    this->simulator.record_latency(VirtualClock::now() - request_time);
+                    fsm.transition_to(ServerState::Idle);
+                }
+            }, nullptr);
+            fsm.set_initial_state(ServerState::Idle);
+            fsm.start();
+            simulator.add(fsm);
+        }
+
+        void request()
+        {
+            request_time = VirtualClock::now();
+            work_left = 10;
+            fsm.transition_to(ServerState::Busy);
+            simulator.wake(fsm);
+        }
+    };
+}
+
+/** @utdef{UT-FSMSIMULATOR-0010 | The virtual clock must only move forward, independently on each thread}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0470
+
+    - GIVEN a virtual clock reset to the epoch
+    - WHEN it is advanced by 1 h, then set back to 1 s, and read from another thread
+    - THEN it reads 1 h on the calling thread, and the epoch on the other thread
+
+ @endut */
+TEST(fsm_simulator, virtual_clock_moves_forward_per_thread)
+{
+    VirtualClock::reset();
+    VirtualClock::advance(1h);
+    VirtualClock::advance_to(VirtualClock::time_point(1s));
+
+    VirtualClock::time_point other_thread_time;
+    std::thread other([&other_thread_time]() { other_thread_time = VirtualClock::now(); });
+    other.join();
+
+    EXPECT_EQ(VirtualClock::now().time_since_epoch(), 1h);
+    EXPECT_EQ(other_thread_time.time_since_epoch(), 0s);
+}
+
+/** @utdef{UT-FSMSIMULATOR-0020 | The simulator must skip the idle time}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0470
+
+    - GIVEN an idle server, updated every minute
+    - WHEN the simulator runs for 7 days of virtual time
+    - THEN the server is updated 10081 times, 7 days are simulated, in less than 1 s of real time, without deadline miss
+
+ @endut */
+TEST(fsm_simulator, skips_the_idle_time)
+{
+    FsmSimulator simulator;
+    Server server(simulator);
+
+    const auto& stats = simulator.run_for(24h * 7);
+
+    EXPECT_EQ(stats.updates, 7u * 24 * 60 + 1);
+    EXPECT_EQ(stats.simulated_time, 24h * 7);
+    EXPECT_EQ(VirtualClock::now().time_since_epoch(), 24h * 7);
+    EXPECT_LT(stats.wall_time, 1s);
+    EXPECT_EQ(stats.deadline_misses, 0u);
+}
+
+/** @utdef{UT-FSMSIMULATOR-0030 | The simulator must call the events at their virtual time}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0470, DNFW-SRS-FSM-0490
+
+    - GIVEN an idle server, and requests scheduled at 10 s and 30 s, the second one scheduled first
+    - WHEN the simulator runs for 1 min
+    - THEN the requests are called in time order, each one is served in 900 ms (10 updates from the request), and the transitions are counted
+
+ @endut */
+TEST(fsm_simulator, calls_the_events_at_their_virtual_time)
+{
+    FsmSimulator simulator;
+    Server server(simulator);
+    std::vector<VirtualClock::duration> request_times;
+
+    simulator.schedule(30s, [&]() { request_times.push_back(VirtualClock::now().time_since_epoch()); server.request(); });
+    simulator.schedule_at(VirtualClock::time_point(10s), [&]() { request_times.push_back(VirtualClock::now().time_since_epoch()); server.request(); });
+
+    const auto& stats = simulator.run_for(1min);
+
+    EXPECT_THAT(request_times, ::testing::ElementsAre(10s, 30s));
+    EXPECT_EQ(stats.events, 2u);
+    EXPECT_EQ(stats.transitions, 4u);
+    EXPECT_EQ(stats.latencies.count(), 2u);
+    EXPECT_EQ(stats.latencies.max(), 900ms);
+    EXPECT_TRUE(server.fsm.is_in_state(ServerState::Idle));
+}
+
+/** @utdef{UT-FSMSIMULATOR-0040 | The simulator must progress with instances without update period}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0470
+
+    - GIVEN a fsm whose state has no update period, and a simulator with a resolution of 10 ms
+    - WHEN the simulator runs for 1 s
+    - THEN the fsm is updated once per resolution step, 101 times, never late
+
+ @endut */
+TEST(fsm_simulator, progresses_with_instances_without_update_period)
+{
+    FsmSimulator simulator;
+    simulator.set_resolution(10ms);
+
+    Fsm fsm;
+    fsm.register_state(ServerState::Idle, nullptr, [](){}, nullptr);
+    fsm.set_initial_state(ServerState::Idle);
+    fsm.start();
+    simulator.add(fsm);
+
+    const auto& stats = simulator.run_for(1s);
+    EXPECT_EQ(stats.updates, 101u);
+    EXPECT_EQ(stats.deadline_misses, 0u);
+    EXPECT_EQ(stats.max_lateness, VirtualClock::duration::zero());
+}
+
+/** @utdef{UT-FSMSIMULATOR-0050 | The latency histogram must report percentiles with a bounded error}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0490
+
+    - GIVEN 2 histograms holding the latencies 1 to 500 ms and 501 to 1000 ms
+    - WHEN they are merged
+    - THEN the histogram counts 1000 latencies, the maximum is 1000 ms, and the median and the 99th percentile are within 12.5% of 500 ms and 990 ms
+
+ @endut */
+TEST(fsm_simulator, reports_latency_percentiles)
+{
+    FsmSimulator::LatencyHistogram first;
+    FsmSimulator::LatencyHistogram second;
+    for (int i = 1; i <= 500; ++i)
+    {
+        first.record(std::chrono::milliseconds(i));
+        second.record(std::chrono::milliseconds(i + 500));
+    }
+
+    first.merge(second);
+
+    EXPECT_EQ(first.count(), 1000u);
+    EXPECT_EQ(first.max(), 1000ms);
+    EXPECT_EQ(first.mean(), 500500us);
+    EXPECT_GE(first.percentile(50), 500ms);
+    EXPECT_LE(first.percentile(50), 500ms * 1.125);
+    EXPECT_GE(first.percentile(99), 990ms);
+    EXPECT_LE(first.percentile(99), 1000ms);
+    EXPECT_EQ(FsmSimulator::LatencyHistogram().percentile(50), 0ms);
+}
+
+/** @utdef{UT-FSMSIMULATOR-0060 | The simulator must run independent seeds in parallel, deterministically}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0480, DNFW-SRS-FSM-0490
+
+    - GIVEN a fleet of 10 servers receiving requests at random times, drawn from the random generator of the simulation
+    - WHEN 8 seeds are simulated for 1 day on a thread pool of 4 threads, twice, and sequentially on the calling thread
+    - THEN the merged statistics of the 3 runs are identical, and count the 8 seeds
+
+ @endut */
+TEST(fsm_simulator, runs_seeds_in_parallel_deterministically)
+{
+    auto setup = [](FsmSimulator& simulator)
+    {
+        auto fleet = std::make_unique<std::vector<std::unique_ptr<Server>>>();
+        std::exponential_distribution<double> interval(1.0 / 600.0);
+
+        for (int i = 0; i < 10; ++i)
+        {
+            auto* server = fleet->emplace_back(std::make_unique<Server>(simulator)).get();
+            for (double time = interval(simulator.random()); time < 86400.0; time += interval(simulator.random()))
+                simulator.schedule(std::chrono::duration_cast<VirtualClock::duration>(std::chrono::duration<double>(time)), [server]() { server->request(); });
+        }
+        return fleet;
+    };
+    const std::vector<std::uint64_t> seeds = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    ThreadPool pool(4);
+    auto first = FsmSimulator::run_seeds(pool, seeds, 24h, setup);
+    auto second = FsmSimulator::run_seeds(pool, seeds, 24h, setup);
+
+    FsmSimulator::Stats sequential;
+    for (auto seed : seeds)
+    {
+        FsmSimulator simulator(seed);
+        auto fleet = setup(simulator);
+        sequential.merge(simulator.run_for(24h));
+    }
+
+    EXPECT_EQ(first.seeds, 8u);
+    EXPECT_EQ(first.simulated_time, 24h * 8);
+    EXPECT_GT(first.events, 0u);
+    for (const auto* other : {&second, &sequential})
+    {
+        EXPECT_EQ(other->seeds, first.seeds);
+        EXPECT_EQ(other->updates, first.updates);
+        EXPECT_EQ(other->transitions, first.transitions);
+        EXPECT_EQ(other->events, first.events);
+        EXPECT_EQ(other->latencies.count(), first.latencies.count());
+        EXPECT_EQ(other->latencies.percentile(99), first.latencies.percentile(99));
+    }
+}
@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <utils/Fsm/StaticFsm.h>
+
+#include <vector>
+
+using app::utils::Fsm;
+using app::utils::NoGuard;
+using app::utils::Row;
+using app::utils::StaticFsm;
+using app::utils::StaticFsmAdapter;
+using app::utils::TransitionTable;
+
+enum struct Door
+{
+    Closed,
+    Open,
+    Locked
+};
+
+struct OpenEvent {};
+struct CloseEvent {};
+struct LockEvent { int code; };
+
+struct DoorContext
+{
+    int code = 1234;
+    int beeps = 0;
+};
+
+struct CodeIsValid
+{
+    constexpr bool operator()(DoorContext& context, const LockEvent& event) const { return event.code == context.code; }
+};
+
+struct Beep
+{
+    constexpr void operator()(DoorContext& context) const { context.beeps++; }
+};
+
+using DoorTable = TransitionTable<
+    Row<Door::Closed, OpenEvent,  Door::Open>,
+    Row<Door::Open,   CloseEvent, Door::Closed, NoGuard, Beep>,
+    Row<Door::Closed, LockEvent,  Door::Locked, CodeIsValid>
+>;
+
+constexpr Door door_after_open_close_lock()
+{
+    DoorContext context;
+    StaticFsm<DoorTable, DoorContext> door(context, Door::Closed);
+    door.process_event(OpenEvent{});
+    door.process_event(CloseEvent{});
+    door.process_event(LockEvent{1234});
+    return door.current_state();
+}
+
+/** @utdef{UT-FSMSTATIC-0010 | A static fsm must be evaluable at compile time}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0240
+
+    - GIVEN the door transition table, starting in the Closed state
+    - WHEN the Open, Close and Lock (with the valid code) events are processed in a constant expression
+    - THEN the door is Locked at compile time
+
+ @endut */
+TEST(fsm_static, process_events_at_compile_time)
+{
+    static_assert(door_after_open_close_lock() == Door::Locked);
+}
+
+/** @utdef{UT-FSMSTATIC-0020 | A static fsm must take the row matching the event, the current state and the guard, and call its action}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0240
+
+    - GIVEN the door transition table, starting in the Closed state
+    - WHEN a Close event is processed
+    - THEN no transition is taken
+    - WHEN a Lock event with an invalid code is processed
+    - THEN no transition is taken
+    - WHEN the Open then the Close events are processed
+    - THEN the door is Closed and the Beep action has been called once
+
+ @endut */
+TEST(fsm_static, process_event_applies_guards_and_actions)
+{
+    DoorContext context;
+    StaticFsm<DoorTable, DoorContext> door(context, Door::Closed);
+
+    EXPECT_FALSE(door.process_event(CloseEvent{}));
+    EXPECT_FALSE(door.process_event(LockEvent{0}));
+    EXPECT_TRUE(door.is_in_state(Door::Closed));
+
+    EXPECT_TRUE(door.process_event(OpenEvent{}));
+    EXPECT_TRUE(door.is_in_state(Door::Open));
+    EXPECT_TRUE(door.process_event(CloseEvent{}));
+    EXPECT_TRUE(door.is_in_state(Door::Closed));
+    EXPECT_EQ(context.beeps, 1);
+}
+
+/** @utdef{UT-FSMSTATIC-0030 | A fsm driven by a transition table must apply its transition and state handler overrides}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0250, DNFW-SRS-FSM-0120, DNFW-SRS-FSM-0130
+
+    - GIVEN a fsm driven by the door transition table through an adapter, started in the Closed state
+    -   AND the handler of the Open state overridden to count its entries
+    -   AND the transition <Open, Closed> overridden to the Locked state
+    - WHEN the Open then the Close events are processed
+    - THEN the overriding Open handler has been entered, and the fsm is in the Locked state
+
+ @endut */
+TEST(fsm_static, adapter_applies_fsm_overrides)
+{
+    Fsm fsm;
+    DoorContext context;
+    StaticFsmAdapter<DoorTable, DoorContext> door(fsm, context);
+    int open_entries = 0;
+
+    fsm.register_state(Door::Open, [&open_entries](){open_entries++;}, [](){}, nullptr);
+    fsm.transition_override(Door::Open, Door::Closed, Door::Locked);
+    fsm.set_initial_state(Door::Closed);
+    fsm.start();
+
+    EXPECT_TRUE(door.process_event(OpenEvent{}));
+    EXPECT_TRUE(door.process_event(CloseEvent{}));
+
+    EXPECT_EQ(open_entries, 1);
+    EXPECT_EQ(context.beeps, 1);
+    EXPECT_TRUE(fsm.is_in_state(Door::Locked));
+    EXPECT_FALSE(door.process_event(OpenEvent{}));
+}
+
+/** @utdef{UT-FSMSTATIC-0040 | A fsm driven by a transition table must call the action of a row before the exit of the source state}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0250
+
+    - GIVEN a fsm driven by the door transition table through an adapter, in the Open state
+    -   AND the exit function of the Open state and the entry function of the Closed state recording the beeps of the context
+    - WHEN the Close event is processed, whose row action beeps
+    - THEN the action has been called before the exit of the Open state and before the entry of the Closed state
+
+ @endut */
+TEST(fsm_static, adapter_calls_the_row_action_before_the_exit_of_the_source_state)
+{
+    Fsm fsm;
+    DoorContext context;
+    StaticFsmAdapter<DoorTable, DoorContext> door(fsm, context);
+    std::vector<int> beeps_on_exit;
+    std::vector<int> beeps_on_enter;
+
+    fsm.register_state(Door::Open, nullptr, [](){}, [&](){beeps_on_exit.push_back(context.beeps);});
+    fsm.register_state(Door::Closed, [&](){beeps_on_enter.push_back(context.beeps);}, [](){}, nullptr);
+    fsm.set_initial_state(Door::Open);
+    fsm.start();
+
+    EXPECT_TRUE(door.process_event(CloseEvent{}));
+
+    EXPECT_THAT(beeps_on_exit, ::testing::ElementsAre(1));
+    EXPECT_THAT(beeps_on_enter, ::testing::ElementsAre(1));
+    EXPECT_TRUE(fsm.is_in_state(Door::Closed));
+}
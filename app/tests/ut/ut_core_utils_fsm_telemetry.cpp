@@ -0,0 +1,350 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <utils/Fsm/FsmTelemetry.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include <unistd.h>
+
+using app::utils::Fsm;
+using app::utils::FsmTelemetry;
+using app::utils::FsmTelemetryReader;
+using app::utils::FsmTelemetrySnapshot;
+
+namespace
+{
+    enum struct DoorState
+    {
+        Closed,
+        Opened
+    };
+
+    /* Unique segment name per test process, so that parallel test runs do not share their segments */
+    std::string segment_name()
+    {
+        return "/ut_fsm_telemetry_" + std::to_string(getpid());
+    }
+
+    void register_door(Fsm& fsm)
+    {
+        fsm.register_state(DoorState::Closed, nullptr, [](){}, nullptr);
+        fsm.register_state(DoorState::Opened, nullptr, [](){}, nullptr);
+        fsm.set_initial_state(DoorState::Closed);
+    }
+}
+
+/** @utdef{UT-FSMTELEMETRY-0010 | The telemetry must publish the current state of an attached instance}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0450
+
+    - GIVEN a started fsm attached to a telemetry segment
+    - WHEN the segment is read by a reader
+    - THEN the reader reports one instance, in its current state, without transition nor update
+
+ @endut */
+TEST(fsm_telemetry, publishes_the_current_state_of_attached_instances)
+{
+    FsmTelemetry telemetry(segment_name(), 4);
+    Fsm fsm;
+    register_door(fsm);
+    fsm.start();
+
+    telemetry.attach(fsm);
+    FsmTelemetryReader reader(segment_name());
+    auto instances = reader.snapshot();
+
+    ASSERT_EQ(instances.size(), 1u);
+    EXPECT_EQ(instances[0].state_name, "Closed");
+    EXPECT_EQ(instances[0].state, fsm.current_state_id().value());
+    EXPECT_EQ(instances[0].transitions, 0u);
+    EXPECT_EQ(instances[0].updates, 0u);
+    EXPECT_EQ(reader.capacity(), 4u);
+}
+
+/** @utdef{UT-FSMTELEMETRY-0020 | The telemetry must publish the transitions and count the updates}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0450
+
+    - GIVEN a fsm attached to a telemetry segment before its start
+    - WHEN the fsm is started, updated 3 times, transitions to another state, then exits
+    - THEN the reader reports the new state after the transition with its timestamp, the exit state after the exit, and the counters
+
+ @endut */
+TEST(fsm_telemetry, publishes_the_transitions_and_counts_the_updates)
+{
+    FsmTelemetry telemetry(segment_name(), 4);
+    FsmTelemetryReader reader(segment_name());
+    Fsm fsm;
+    register_door(fsm);
+    telemetry.attach(fsm);
+
+    fsm.start();
+    fsm.update();
+    fsm.update();
+    auto before_transition = app::utils::Tsc::now();
+    fsm.transition_to(DoorState::Opened);
+    fsm.update();
+
+    auto instances = reader.snapshot();
+    ASSERT_EQ(instances.size(), 1u);
+    EXPECT_EQ(instances[0].state_name, "Opened");
+    EXPECT_EQ(instances[0].transitions, 2u);
+    EXPECT_EQ(instances[0].updates, 3u);
+    EXPECT_GE(instances[0].transition_ticks, before_transition);
+    EXPECT_GE(reader.time_in_state(instances[0]).count(), 0);
+
+    fsm.exit();
+    instances = reader.snapshot();
+    ASSERT_EQ(instances.size(), 1u);
+    EXPECT_EQ(instances[0].state_name, "Exit");
+    EXPECT_EQ(instances[0].transitions, 3u);
+}
+
+/** @utdef{UT-FSMTELEMETRY-0030 | The telemetry must stop reporting the detached and destroyed instances}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0450
+
+    - GIVEN 3 started fsm attached to a telemetry segment of capacity 3
+    - WHEN one fsm is detached and another one is destroyed
+    - THEN the reader reports a single instance, and 2 new instances can be attached to the freed slots, but not a third one
+
+ @endut */
+TEST(fsm_telemetry, stops_reporting_detached_and_destroyed_instances)
+{
+    FsmTelemetry telemetry(segment_name(), 3);
+    FsmTelemetryReader reader(segment_name());
+
+    Fsm detached;
+    Fsm kept;
+    auto destroyed = std::make_unique<Fsm>();
+    for (auto* fsm : {&detached, &kept, destroyed.get()})
+    {
+        register_door(*fsm);
+        fsm->start();
+        telemetry.attach(*fsm);
+    }
+
+    telemetry.detach(detached);
+    destroyed.reset();
+
+    EXPECT_EQ(reader.snapshot().size(), 1u);
+    EXPECT_EQ(detached.get_telemetry_slot(), nullptr);
+
+    std::array<Fsm, 3> newcomers;
+    telemetry.attach(newcomers[0]);
+    telemetry.attach(newcomers[1]);
+    EXPECT_THROW(telemetry.attach(newcomers[2]), std::runtime_error);
+    EXPECT_EQ(reader.snapshot().size(), 3u);
+}
+
+/** @utdef{UT-FSMTELEMETRY-0040 | The reader must report the distribution of the states}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0460
+
+    - GIVEN 5 started fsm attached to a telemetry segment, 2 of them opened
+    - WHEN the state distribution is read
+    - THEN the reader reports 3 closed and 2 opened instances
+
+ @endut */
+TEST(fsm_telemetry, reports_the_state_distribution)
+{
+    FsmTelemetry telemetry(segment_name(), 8);
+    std::array<Fsm, 5> fleet;
+    for (auto& fsm : fleet)
+    {
+        register_door(fsm);
+        fsm.start();
+        telemetry.attach(fsm);
+    }
+    fleet[1].transition_to(DoorState::Opened);
+    fleet[3].transition_to(DoorState::Opened);
+
+    FsmTelemetryReader reader(segment_name());
+    auto distribution = reader.state_distribution();
+
+    EXPECT_EQ(distribution.size(), 2u);
+    EXPECT_EQ(distribution["Closed"], 3u);
+    EXPECT_EQ(distribution["Opened"], 2u);
+}
+
+/** @utdef{UT-FSMTELEMETRY-0050 | The reader must get consistent snapshots while the fsm is running}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0450, DNFW-SRS-FSM-0460
+
+    - GIVEN a fsm attached to a telemetry segment, transitioning continuously between 2 states on a thread
+    - WHEN the segment is read continuously on another thread
+    - THEN each snapshot is consistent: the state name matches the state identifier, and the transitions counter never decreases
+
+ @endut */
+TEST(fsm_telemetry, reads_consistent_snapshots_while_running)
+{
+    FsmTelemetry telemetry(segment_name(), 1);
+    FsmTelemetryReader reader(segment_name());
+    Fsm fsm;
+    register_door(fsm);
+    fsm.start();
+    telemetry.attach(fsm);
+
+    const auto closed = app::utils::StateId(DoorState::Closed).value();
+    const auto opened = app::utils::StateId(DoorState::Opened).value();
+
+    std::atomic<bool> running{true};
+    std::thread writer([&]()
+    {
+        for (int i = 0; running.load(std::memory_order_relaxed); ++i)
+        {
+            if (i % 2)
+                fsm.transition_to(DoorState::Closed);
+            else
+                fsm.transition_to(DoorState::Opened);
+        }
+    });
+
+    std::uint64_t last_transitions = 0;
+    int inconsistent = 0;
+    for (int read = 0; read < 100000; ++read)
+    {
+        auto instances = reader.snapshot();
+        ASSERT_EQ(instances.size(), 1u);
+        const auto& instance = instances[0];
+
+        if (!((instance.state == closed && instance.state_name == "Closed") || (instance.state == opened && instance.state_name == "Opened")))
+            ++inconsistent;
+        if (instance.transitions < last_transitions)
+            ++inconsistent;
+        last_transitions = instance.transitions;
+    }
+
+    running = false;
+    writer.join();
+
+    EXPECT_EQ(inconsistent, 0);
+}
+
+/** @utdef{UT-FSMTELEMETRY-0060 | The reader must reject a missing or invalid segment}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0460
+
+    - GIVEN no telemetry segment, then a shared memory segment which is not a telemetry segment
+    - WHEN a reader maps them
+    - THEN the reader throws a system error, then a runtime error
+
+ @endut */
+TEST(fsm_telemetry, rejects_missing_and_invalid_segments)
+{
+    auto name = segment_name() + "_invalid";
+    shm_unlink(name.c_str());
+
+    EXPECT_THROW(FsmTelemetryReader reader(name), std::system_error);
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(ftruncate(fd, 4096), 0);
+    close(fd);
+
+    EXPECT_THROW(FsmTelemetryReader reader(name), std::runtime_error);
+    shm_unlink(name.c_str());
+}
+
+/** @utdef{UT-FSMTELEMETRY-0070 | The telemetry must detach the instances still attached when destroyed}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0450
+
+    - GIVEN 2 started fsm attached to a telemetry segment, one of them destroyed before the segment
+    - WHEN the telemetry is destroyed, then the remaining fsm takes a transition, is updated and is destroyed
+    - THEN the remaining fsm has no telemetry slot anymore, and neither the fsm nor the telemetry accesses the unmapped segment
+
+ @endut */
+TEST(fsm_telemetry, detaches_the_attached_instances_when_destroyed)
+{
+    auto telemetry = std::make_unique<FsmTelemetry>(segment_name(), 2);
+    auto destroyed_first = std::make_unique<Fsm>();
+    auto outliving = std::make_unique<Fsm>();
+    for (auto* fsm : {destroyed_first.get(), outliving.get()})
+    {
+        register_door(*fsm);
+        fsm->start();
+        telemetry->attach(*fsm);
+    }
+
+    destroyed_first.reset();
+    telemetry.reset();
+
+    EXPECT_EQ(outliving->get_telemetry_slot(), nullptr);
+    outliving->transition_to(DoorState::Opened);
+    outliving->update();
+    EXPECT_TRUE(outliving->is_in_state(DoorState::Opened));
+    outliving.reset();
+}
+
+/** @utdef{UT-FSMTELEMETRY-0080 | The reader must report a slot left in the middle of a write as torn}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0460
+
+    - GIVEN a slot in use whose sequence is left odd, as by a writer which crashed in the middle of a write
+    - WHEN the slot is read
+    - THEN the read returns after a bounded number of attempts, reporting the slot as torn, labelled "torn" by the reader
+
+ @endut */
+TEST(fsm_telemetry, reports_a_slot_left_in_the_middle_of_a_write_as_torn)
+{
+    app::utils::FsmTelemetrySlot slot;
+    slot.attach(static_cast<int>(DoorState::Closed), "Closed", 0);
+    slot.sequence.fetch_add(1);
+
+    FsmTelemetrySnapshot snapshot;
+    EXPECT_TRUE(slot.read(snapshot));
+    EXPECT_TRUE(snapshot.torn);
+    EXPECT_EQ(FsmTelemetryReader::state_label(snapshot), "torn");
+
+    slot.sequence.fetch_add(1);
+    EXPECT_TRUE(slot.read(snapshot));
+    EXPECT_FALSE(snapshot.torn);
+    EXPECT_EQ(snapshot.state_name, "Closed");
+}
+
+/** @utdef{UT-FSMTELEMETRY-0090 | The telemetry must not replace an existing segment}
+    :layout: test
+    :tags: app, swc, fsm
+    :checks: DNFW-SRS-FSM-0450
+
+    - GIVEN a telemetry segment with an attached instance, and a segment with another name left without telemetry (as by a crashed process)
+    - WHEN a telemetry is created with the name of each segment
+    - THEN both creations throw, the instance is still reported, and the left segment can be created once removed
+
+ @endut */
+TEST(fsm_telemetry, does_not_replace_an_existing_segment)
+{
+    FsmTelemetry telemetry(segment_name(), 2);
+    Fsm fsm;
+    register_door(fsm);
+    fsm.start();
+    telemetry.attach(fsm);
+
+    EXPECT_THROW(FsmTelemetry replacing(segment_name(), 2), std::system_error);
+    FsmTelemetryReader reader(segment_name());
+    auto snapshots = reader.snapshot();
+    ASSERT_EQ(snapshots.size(), 1u);
+    EXPECT_EQ(FsmTelemetryReader::state_distribution(snapshots)["Closed"], 1u);
+
+    auto left = segment_name() + "_left";
+    int fd = shm_open(left.c_str(), O_CREAT | O_RDWR, 0600);
+    ASSERT_GE(fd, 0);
+    close(fd);
+
+    EXPECT_THROW(FsmTelemetry replacing(left, 2), std::system_error);
+    EXPECT_TRUE(FsmTelemetry::remove_segment(left));
+    EXPECT_NO_THROW(FsmTelemetry created(left, 2));
+    EXPECT_FALSE(FsmTelemetry::remove_segment(left));
+}
@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <utils/Reactor/Reactor.h>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+using app::utils::Fsm;
+using app::utils::Reactor;
+
+namespace
+{
+    /* Pipe closed at the end of the test */
+    struct Pipe
+    {
+        int fds[2];
+        Pipe() { EXPECT_EQ(::pipe(fds), 0); }
+        ~Pipe() { ::close(fds[0]); ::close(fds[1]); }
+        int read_end() const { return fds[0]; }
+        int write_end() const { return fds[1]; }
+        void write_byte() const { char byte = 1; EXPECT_EQ(::write(fds[1], &byte, 1), 1); }
+        void read_byte() const { char byte; EXPECT_EQ(::read(fds[0], &byte, 1), 1); }
+    };
+
+    enum struct ConnectionState
+    {
+        Waiting,
+        Receiving
+    };
+}
+
+/** @utdef{UT-REACTOR-0010 | Polling with no ready file descriptor must return after the timeout without calling any handler}
+    :layout: test
+    :tags: app, swc, reactor
+    :checks: DNFW-SRS-REACTOR-0010, DNFW-SRS-REACTOR-0020
+
+    - GIVEN a reactor with a registered pipe with no data
+    - WHEN the reactor is polled with a timeout
+    - THEN no handler is called and poll() returns 0
+
+ @endut */
+TEST(reactor, poll_times_out_when_nothing_is_ready)
+{
+    Reactor reactor;
+    Pipe pipe;
+    int calls = 0;
+
+    reactor.add(pipe.read_end(), EPOLLIN, [&calls](std::uint32_t){calls++;});
+
+    EXPECT_EQ(reactor.poll(std::chrono::milliseconds(1)), 0u);
+    EXPECT_EQ(calls, 0);
+}
+
+/** @utdef{UT-REACTOR-0020 | Polling must call the handlers of all the ready file descriptors in a single batch}
+    :layout: test
+    :tags: app, swc, reactor
+    :checks: DNFW-SRS-REACTOR-0010, DNFW-SRS-REACTOR-0020
+
+    - GIVEN a reactor with three registered pipes, two of them with data
+    - WHEN the reactor is polled
+    - THEN the handlers of the two readable pipes are called with EPOLLIN, and poll() returns 2
+
+ @endut */
+TEST(reactor, poll_dispatches_ready_file_descriptors_as_a_batch)
+{
+    Reactor reactor;
+    Pipe pipes[3];
+    std::vector<int> ready;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        reactor.add(pipes[i].read_end(), EPOLLIN, [&ready, &pipes, i](std::uint32_t events)
+        {
+            EXPECT_TRUE(events & EPOLLIN);
+            pipes[i].read_byte();
+            ready.push_back(i);
+        });
+    }
+
+    pipes[0].write_byte();
+    pipes[2].write_byte();
+
+    EXPECT_EQ(reactor.poll(std::chrono::milliseconds(100)), 2u);
+    EXPECT_THAT(ready, testing::UnorderedElementsAre(0, 2));
+}
+
+/** @utdef{UT-REACTOR-0030 | An unregistered file descriptor must not be reported anymore}
+    :layout: test
+    :tags: app, swc, reactor
+    :checks: DNFW-SRS-REACTOR-0010
+
+    - GIVEN a reactor with a registered pipe with data
+    - WHEN the pipe is unregistered and the reactor is polled
+    - THEN its handler is not called
+
+ @endut */
+TEST(reactor, removed_file_descriptor_is_not_dispatched)
+{
+    Reactor reactor;
+    Pipe pipe;
+    int calls = 0;
+
+    reactor.add(pipe.read_end(), EPOLLIN, [&calls](std::uint32_t){calls++;});
+    pipe.write_byte();
+    reactor.remove(pipe.read_end());
+
+    EXPECT_EQ(reactor.poll(std::chrono::milliseconds(1)), 0u);
+    EXPECT_EQ(calls, 0);
+    EXPECT_EQ(reactor.size(), 0u);
+    EXPECT_THROW(reactor.remove(pipe.read_end()), std::system_error);
+}
+
+/** @utdef{UT-REACTOR-0035 | A file descriptor closed before being unregistered must be unregistered}
+    :layout: test
+    :tags: app, swc, reactor
+    :checks: DNFW-SRS-REACTOR-0010
+
+    - GIVEN a reactor with a registered pipe
+    - WHEN the pipe is closed, then unregistered, and a new pipe reusing the closed file descriptor number is registered
+    - THEN the unregistration and the registration succeed, and the new pipe is dispatched to its handler
+
+ @endut */
+TEST(reactor, closed_file_descriptor_is_unregistered)
+{
+    Reactor reactor;
+    auto closed = std::make_unique<Pipe>();
+    int closed_fd = closed->read_end();
+    reactor.add(closed_fd, EPOLLIN, [](std::uint32_t){});
+
+    closed.reset();
+    EXPECT_NO_THROW(reactor.remove(closed_fd));
+    EXPECT_EQ(reactor.size(), 0u);
+
+    Pipe reused;
+    ASSERT_EQ(reused.read_end(), closed_fd);
+    int calls = 0;
+    EXPECT_NO_THROW(reactor.add(reused.read_end(), EPOLLIN, [&calls](std::uint32_t){calls++;}));
+    reused.write_byte();
+
+    EXPECT_EQ(reactor.poll(std::chrono::milliseconds(100)), 1u);
+    EXPECT_EQ(calls, 1);
+}
+
+/** @utdef{UT-REACTOR-0040 | Waking up the reactor from another thread must unblock the poll}
+    :layout: test
+    :tags: app, swc, reactor
+    :checks: DNFW-SRS-REACTOR-0030
+
+    - GIVEN a reactor polled without timeout
+    - WHEN another thread wakes up the reactor
+    - THEN poll() returns 0
+
+ @endut */
+TEST(reactor, wakeup_unblocks_poll)
+{
+    Reactor reactor;
+
+    std::thread waker([&reactor]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        reactor.wakeup();
+    });
+
+    EXPECT_EQ(reactor.poll(), 0u);
+    waker.join();
+}
+
+/** @utdef{UT-REACTOR-0050 | The readiness of a file descriptor bound to a transition must initiate the transition of the fsm}
+    :layout: test
+    :tags: app, swc, reactor
+    :checks: DNFW-SRS-REACTOR-0040
+
+    - GIVEN a started fsm in the Waiting state, and a socket bound to the transition to the Receiving state
+    - WHEN data is sent on the peer socket and the reactor is polled
+    - THEN the fsm is in the Receiving state, whose enter function consumed the data
+
+ @endut */
+TEST(reactor, readiness_initiates_fsm_transition)
+{
+    Reactor reactor;
+    Fsm fsm;
+    int sockets[2];
+    ASSERT_EQ(::socketpair(AF_UNIX, SOCK_STREAM, 0, sockets), 0);
+
+    char received = 0;
+    fsm.register_state(ConnectionState::Waiting, nullptr, [](){}, nullptr);
+    fsm.register_state(ConnectionState::Receiving, [&received, &sockets](){EXPECT_EQ(::read(sockets[0], &received, 1), 1);}, [](){}, nullptr);
+    fsm.set_initial_state(ConnectionState::Waiting);
+    fsm.start();
+
+    reactor.add_transition(sockets[0], EPOLLIN, fsm, ConnectionState::Receiving);
+
+    char byte = 42;
+    ASSERT_EQ(::write(sockets[1], &byte, 1), 1);
+
+    EXPECT_EQ(reactor.poll(std::chrono::milliseconds(100)), 1u);
+    EXPECT_TRUE(fsm.is_in_state(ConnectionState::Receiving));
+    EXPECT_EQ(received, 42);
+
+    ::close(sockets[0]);
+    ::close(sockets[1]);
+}
+
+/** @utdef{UT-REACTOR-0060 | A failed registration must leave the registered handlers unchanged}
+    :layout: test
+    :tags: app, swc, reactor
+    :checks: DNFW-SRS-REACTOR-0010
+
+    - GIVEN a reactor with a registered pipe with data
+    - WHEN an invalid file descriptor is registered, then the pipe is registered again with another handler
+    - THEN both registrations throw, the invalid file descriptor has no handler, and the pipe is still dispatched to its first handler
+
+ @endut */
+TEST(reactor, failed_registration_leaves_handlers_unchanged)
+{
+    Reactor reactor;
+    Pipe pipe;
+    int first_calls = 0;
+    int second_calls = 0;
+
+    reactor.add(pipe.read_end(), EPOLLIN, [&first_calls](std::uint32_t){first_calls++;});
+    pipe.write_byte();
+
+    EXPECT_THROW(reactor.add(-1, EPOLLIN, [](std::uint32_t){}), std::system_error);
+    EXPECT_EQ(reactor.size(), 1u);
+    EXPECT_THROW(reactor.remove(-1), std::system_error);
+
+    EXPECT_THROW(reactor.add(pipe.read_end(), EPOLLIN, [&second_calls](std::uint32_t){second_calls++;}), std::system_error);
+    EXPECT_EQ(reactor.size(), 1u);
+
+    EXPECT_EQ(reactor.poll(std::chrono::milliseconds(100)), 1u);
+    EXPECT_EQ(first_calls, 1);
+    EXPECT_EQ(second_calls, 0);
+}
@@ -24,10 +24,14 @@ function (FetchTestFramework)
 endfunction()
 
 
+# Add a unit test executable.
+#
+# With the INSTRUMENTED option, the test is linked with the INSTRUMENTATION_TARGET (e.g. a counting replacement of the global
+# operator new) and compiled with UT_INSTRUMENTED defined, to enable the allocation and latency assertions.
 function (gtest_add_unittest unittest_name)
   
-  set(options "")
-  set(oneValueArgs UT_SOURCE UUT_SOURCE SOURCE_BASE_DIR)
+  set(options INSTRUMENTED)
+  set(oneValueArgs UT_SOURCE UUT_SOURCE SOURCE_BASE_DIR INSTRUMENTATION_TARGET)
   set(multiValueArgs ADDITIONAL_SOURCES ADDITIONAL_LIBS RESOURCES_DIR UUT_DIR)
 
   cmake_parse_arguments(ARG "${options}" "${oneValueArgs}" "${multiValueArgs}" ${ARGN} )
@@ -51,6 +55,14 @@ function (gtest_add_unittest unittest_name)
     ${ARG_ADDITIONAL_LIBS}
     GTest::gtest_main GTest::gtest GTest::gmock
   )
+
+  if (ARG_INSTRUMENTED)
+    if (NOT TARGET "${ARG_INSTRUMENTATION_TARGET}")
+      message(FATAL_ERROR "${unittest_name}: INSTRUMENTED requires an existing INSTRUMENTATION_TARGET")
+    endif()
+    target_link_libraries(${unittest_name} ${ARG_INSTRUMENTATION_TARGET})
+    target_compile_definitions(${unittest_name} PRIVATE UT_INSTRUMENTED)
+  endif()
   
   gtest_discover_tests(${unittest_name})
  